@@ -0,0 +1,127 @@
+// 请求头解析微基准：逐行 findCRLF + std::find(':') 的旧扫描方式 vs HttpScanner 单次向量化扫描
+// 编译：g++ -std=c++17 -O2 -I../include bench_http_parser.cc ../src/http/HttpScanner.cpp
+//       ../src/http/HttpContext.cpp ../src/http/HttpRequest.cpp -lmuduo_net -lmuduo_base -lpthread
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <muduo/net/Buffer.h>
+
+#include "../include/http/HttpContext.h"
+#include "../include/http/HttpScanner.h"
+
+// 浏览器实际发出的请求头
+static const char kChromeGet[] =
+    "GET /menu HTTP/1.1\r\n"
+    "Host: growingshark.asia\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+    "sec-ch-ua-mobile: ?0\r\n"
+    "sec-ch-ua-platform: \"Windows\"\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) "
+    "Chrome/124.0.0.0 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,"
+    "image/apng,*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "Sec-Fetch-Mode: navigate\r\n"
+    "Sec-Fetch-User: ?1\r\n"
+    "Sec-Fetch-Dest: document\r\n"
+    "Referer: http://growingshark.asia/entry\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8\r\n"
+    "Cookie: sessionId=3f9a0c7e1b2d4e5f8a6b7c8d9e0f1a2b\r\n"
+    "\r\n";
+
+static const char kFirefoxPost[] =
+    "POST /aiBot/move HTTP/1.1\r\n"
+    "Host: growingshark.asia\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 Firefox/125.0\r\n"
+    "Accept: */*\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: http://growingshark.asia/menu\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 15\r\n"
+    "Origin: http://growingshark.asia\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: sessionId=3f9a0c7e1b2d4e5f8a6b7c8d9e0f1a2b\r\n"
+    "Sec-Fetch-Dest: empty\r\n"
+    "Sec-Fetch-Mode: cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "\r\n"
+    "{\"x\":7,\"y\":8}\r\n";
+
+// 旧解析器的扫描方式：每行一次 findCRLF，再对该行 std::find 冒号
+static size_t legacyScan(muduo::net::Buffer* buf)
+{
+    size_t lines = 0;
+    const char* start = buf->peek();
+    const char* crlf;
+    while ((crlf = buf->findCRLF(start)) != nullptr)
+    {
+        if (crlf == start)
+        {
+            break;
+        }
+        const char* colon = std::find(start, crlf, ':');
+        lines += (colon < crlf);
+        start = crlf + 2;
+    }
+    return lines;
+}
+
+template <typename F>
+static void bench(const char* name, int iterations, size_t bytes, F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        sink += f();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+    std::cout << name << ": " << ns << " ns/req, "
+              << bytes / ns << " GB/s (sink " << sink << ")" << std::endl;
+}
+
+static void run(const char* label, const std::string& request, int iterations)
+{
+    std::cout << "== " << label << " (" << request.size() << " bytes, scanner "
+              << http::HttpScanner::implName() << ")" << std::endl;
+
+    muduo::net::Buffer buf;
+    buf.append(request.data(), request.size());
+
+    bench("legacy findCRLF+find", iterations, request.size(), [&] {
+        return legacyScan(&buf);
+    });
+
+    http::HttpScanner::State state;
+    bench("HttpScanner::scanHead", iterations, request.size(), [&] {
+        state.reset();
+        return http::HttpScanner::scanHead(buf.peek(), buf.readableBytes(), &state);
+    });
+
+    http::HttpContext context;
+    bench("HttpContext::parseRequest", iterations, request.size(), [&] {
+        muduo::net::Buffer input;
+        input.append(request.data(), request.size());
+        context.parseRequest(&input, muduo::Timestamp());
+        size_t n = context.request().headers().size();
+        context.reset();
+        return n;
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    run("Chrome GET", kChromeGet, iterations);
+    run("Firefox POST", kFirefoxPost, iterations);
+    return 0;
+}
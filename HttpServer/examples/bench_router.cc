@@ -0,0 +1,150 @@
+// 路由匹配微基准：数百条路由下，旧的 std::regex 逐条匹配 vs 前缀树 Router
+// 编译：g++ -std=c++17 -O2 -I../include bench_router.cc ../src/router/Router.cpp
+//       ../src/router/RouteTree.cpp ../src/http/HttpRequest.cpp -lmuduo_net -lmuduo_base -lpthread
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../include/router/Router.h"
+
+using http::HttpRequest;
+using http::HttpResponse;
+using http::router::Router;
+
+// 旧实现的动态路由：模式转成正则后按注册顺序逐条匹配
+struct LegacyRoute
+{
+    HttpRequest::Method method;
+    std::regex          pathRegex;
+};
+
+static std::regex convertToRegex(const std::string& pathPattern)
+{
+    std::string regexPattern = "^" + std::regex_replace(pathPattern, std::regex(R"(/:([^/<]+)(<[a-z]+>)?)"), R"(/([^/]+))") + "$";
+    return std::regex(regexPattern);
+}
+
+static const char* kResources[] = {
+    "user", "game", "room", "match", "chat", "rank", "friend", "message",
+    "notice", "replay", "skin", "shop", "order", "item", "task", "mail",
+    "guild", "season", "report", "admin",
+};
+
+// 每种资源注册 4 静态 + 7 动态，20 种资源 x 2 个版本共 440 条
+static std::vector<std::pair<HttpRequest::Method, std::string>> buildPatterns()
+{
+    std::vector<std::pair<HttpRequest::Method, std::string>> patterns;
+    for (const char* version : {"v1", "v2"})
+    {
+        for (const char* res : kResources)
+        {
+            std::string base = std::string("/api/") + version + "/" + res;
+            patterns.emplace_back(HttpRequest::kGet, base);
+            patterns.emplace_back(HttpRequest::kPost, base);
+            patterns.emplace_back(HttpRequest::kGet, base + "/list");
+            patterns.emplace_back(HttpRequest::kGet, base + "/search");
+            patterns.emplace_back(HttpRequest::kGet, base + "/:id<int>");
+            patterns.emplace_back(HttpRequest::kPut, base + "/:id<int>");
+            patterns.emplace_back(HttpRequest::kDelete, base + "/:id<int>");
+            patterns.emplace_back(HttpRequest::kGet, base + "/:id<int>/detail");
+            patterns.emplace_back(HttpRequest::kGet, base + "/:id<int>/history/:page");
+            patterns.emplace_back(HttpRequest::kGet, base + "/by-token/:token<uuid>");
+            patterns.emplace_back(HttpRequest::kGet, base + "/files/*path");
+        }
+    }
+    return patterns;
+}
+
+template <typename F>
+static void bench(const char* name, int iterations, F&& f)
+{
+    auto begin = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        sink += f(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+    std::cout << name << ": " << ns << " ns/lookup (sink " << sink << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+
+    auto patterns = buildPatterns();
+    Router router;
+    std::vector<LegacyRoute> legacy;
+    std::string lastParams;
+    for (const auto& [method, pattern] : patterns)
+    {
+        router.registerCallback(method, pattern, [&lastParams](const HttpRequest& req, HttpResponse*) {
+            lastParams = req.getPathParameters("id") + "|" + req.getPathParameters("path");
+        });
+        legacy.push_back({method, convertToRegex(pattern)});
+    }
+
+    // 请求路径分布：前/中/后各处的静态与动态路由，以及一个不存在的路径
+    std::vector<std::pair<std::string, std::string>> targets = {
+        {"GET", "/api/v1/user"},
+        {"GET", "/api/v1/game/42"},
+        {"GET", "/api/v2/mail/list"},
+        {"GET", "/api/v2/guild/1001/history/3"},
+        {"GET", "/api/v2/admin/by-token/3f9a0c7e-1b2d-4e5f-8a6b-7c8d9e0f1a2b"},
+        {"GET", "/api/v2/report/files/2024/05/log.txt"},
+        {"DELETE", "/api/v2/season/7"},
+        {"GET", "/api/v2/season/not-a-number"},
+    };
+    std::vector<std::pair<HttpRequest::Method, std::string>> paths;
+    std::vector<HttpRequest> requests(targets.size());
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        const std::string& method = targets[i].first;
+        requests[i].setMethod(method.data(), method.data() + method.size());
+        requests[i].setPath(targets[i].second);
+        paths.emplace_back(requests[i].method(), targets[i].second);
+    }
+
+    std::cout << "== " << patterns.size() << " routes, " << paths.size() << " request paths" << std::endl;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        HttpResponse resp;
+        lastParams.clear();
+        bool found = router.route(requests[i], &resp);
+        std::cout << "  " << paths[i].second << " -> " << (found ? lastParams : "404") << std::endl;
+    }
+
+    bench("legacy regex scan", iterations / 10, [&](int i) {
+        const auto& [method, path] = paths[i % paths.size()];
+        for (const auto& route : legacy)
+        {
+            std::smatch match;
+            if (route.method == method && std::regex_match(path, match, route.pathRegex))
+            {
+                return size_t(1);
+            }
+        }
+        return size_t(0);
+    });
+
+    // 只比较查找本身：与旧实现一样只匹配不提取参数
+    http::router::RouteTree trees[HttpRequest::kOptions + 1];
+    for (size_t i = 0; i < patterns.size(); ++i)
+    {
+        trees[patterns[i].first].insert(patterns[i].second, static_cast<int>(i));
+    }
+    http::router::RouteTree::Params params;
+    bench("RouteTree::match", iterations, [&](int i) {
+        const auto& [method, path] = paths[i % paths.size()];
+        return size_t(trees[method].match(path, &params) >= 0);
+    });
+
+    bench("Router::route", iterations, [&](int i) {
+        HttpResponse resp;
+        return size_t(router.route(requests[i % requests.size()], &resp));
+    });
+    return 0;
+}
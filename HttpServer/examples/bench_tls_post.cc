@@ -0,0 +1,155 @@
+// TLS 大请求体吞吐基准：客户端经 TLS 向 HttpServer 连续 POST 大请求体，统计服务端的接收吞吐
+// 编译：g++ -std=c++17 -O2 -I../include bench_tls_post.cc ../src/http/*.cpp ../src/router/*.cpp
+//       ../src/middleware/*.cpp ../src/middleware/cors/*.cpp ../src/session/*.cpp ../src/ssl/*.cpp
+//       -lmuduo_net -lmuduo_base -lssl -lcrypto -lpthread
+// 运行：./bench_tls_post cert.pem key.pem [请求体MB] [请求数] [端口]
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include "../include/http/HttpServer.h"
+
+static bool writeAll(SSL* ssl, const std::string& data)
+{
+    size_t off = 0;
+    while (off < data.size())
+    {
+        int n = SSL_write(ssl, data.data() + off, static_cast<int>(data.size() - off));
+        if (n <= 0)
+        {
+            return false;
+        }
+        off += n;
+    }
+    return true;
+}
+
+// 读取一个带 Content-Length 的响应，返回响应体
+static std::string readResponse(SSL* ssl)
+{
+    std::string data;
+    char buf[4096];
+    size_t headEnd = std::string::npos;
+    size_t total = 0;
+    for (;;)
+    {
+        if (headEnd == std::string::npos)
+        {
+            headEnd = data.find("\r\n\r\n");
+            if (headEnd != std::string::npos)
+            {
+                size_t pos = data.find("Content-Length: ");
+                size_t length = pos < headEnd ? std::stoul(data.substr(pos + 16)) : 0;
+                total = headEnd + 4 + length;
+            }
+        }
+        if (headEnd != std::string::npos && data.size() >= total)
+        {
+            return data.substr(headEnd + 4, total - headEnd - 4);
+        }
+        int n = SSL_read(ssl, buf, sizeof buf);
+        if (n <= 0)
+        {
+            return std::string();
+        }
+        data.append(buf, n);
+    }
+}
+
+// 客户端：同一条 TLS 连接上依次发送 requests 个请求体为 bodySize 的 POST
+static int runClient(int port, size_t bodySize, int requests)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(500)); // 等待服务端开始监听
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0)
+    {
+        perror("connect");
+        return 1;
+    }
+    SSL_CTX* ctx = SSL_CTX_new(TLS_client_method());
+    SSL* ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    if (SSL_connect(ssl) != 1)
+    {
+        ERR_print_errors_fp(stderr);
+        return 1;
+    }
+    std::cout << "== " << SSL_get_version(ssl) << " " << SSL_get_cipher(ssl) << ", "
+              << (bodySize >> 20) << " MB x " << requests << " requests" << std::endl;
+
+    std::string request = "POST /upload HTTP/1.1\r\nHost: localhost\r\nContent-Length: "
+                        + std::to_string(bodySize) + "\r\n\r\n" + std::string(bodySize, 'x');
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < requests; ++i)
+    {
+        if (!writeAll(ssl, request) || readResponse(ssl) != std::to_string(bodySize))
+        {
+            std::cerr << "request " << i << " failed" << std::endl;
+            return 1;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    double mb = static_cast<double>(request.size()) * requests / (1 << 20);
+    std::cout << mb << " MB in " << seconds << " s, " << mb / seconds << " MB/s" << std::endl;
+
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    SSL_CTX_free(ctx);
+    ::close(fd);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "usage: " << argv[0] << " cert.pem key.pem [bodyMB] [requests] [port]" << std::endl;
+        return 1;
+    }
+    size_t bodySize = (argc > 3 ? std::stoul(argv[3]) : 16) << 20;
+    int requests = argc > 4 ? std::stoi(argv[4]) : 20;
+    int port = argc > 5 ? std::stoi(argv[5]) : 8443;
+
+    muduo::Logger::setLogLevel(muduo::Logger::WARN);
+
+    // 服务端：只返回收到的请求体长度
+    http::HttpServer server(port, "bench-tls", true);
+    ssl::SslConfig config;
+    config.setCertificateFile(argv[1]);
+    config.setPrivateKeyFile(argv[2]);
+    server.setSslConfig(config);
+    server.setMaxBodySize(bodySize);
+    server.Post("/upload", [](const http::HttpRequest& req, http::HttpResponse* resp) {
+        std::string body = std::to_string(req.getBody().size());
+        resp->setStatusCode(http::HttpResponse::k200Ok);
+        resp->setStatusMessage("OK");
+        resp->setContentType("text/plain");
+        resp->setContentLength(body.size());
+        resp->setBody(body);
+    });
+    // 客户端在单独的线程中运行，EventLoop 必须在创建它的主线程中 loop
+    int ret = 0;
+    std::thread client([&] {
+        ret = runClient(port, bodySize, requests);
+        server.getLoop()->quit();
+    });
+    server.start();
+    client.join();
+    return ret;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string_view>
+
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+// 每个 IO 线程缓存一份格式化好的 "Date: ...\r\n" 响应头，
+// 由所在 EventLoop 的定时器每秒刷新一次，序列化响应时直接追加，不再逐个响应格式化时间
+class DateCache
+{
+public:
+    // 在 loop 所在线程调用，立即生成一次并注册每秒刷新的定时器
+    static void install(muduo::net::EventLoop* loop);
+
+    // 当前线程缓存的 Date 响应头（含结尾的 \r\n）；
+    // 未安装定时器的线程（如 IO 线程之外）按需检查秒数变化后刷新
+    static std::string_view header();
+
+private:
+    static void refresh();
+};
+
+} // namespace http
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HttpResponse.h"
+
+namespace http
+{
+
+// 预编译的页面模板：页面只解析一次，得到静态片段和具名插槽
+// 渲染时响应体由缓存的静态片段和少量动态字符串依次组成，直接作为分散的响应体段发送，不拼接新的缓冲区
+// 插值不做 HTML 转义，插入用户输入前需自行转义
+class HtmlTemplate : public std::enable_shared_from_this<HtmlTemplate>
+{
+public:
+    // 只把 slotNames 中列出的 {{name}} 解析为插槽，其余 {{...}}（如页面脚本中的文本）原样保留
+    static std::shared_ptr<HtmlTemplate> compile(std::string text,
+                                                 const std::vector<std::string>& slotNames = {});
+
+    // 在第一个 marker 之前增加名为 name 的插槽，未找到 marker 时返回 false
+    // 用于在不修改页面文件的情况下注入内容（如 </head> 之前的脚本），须在渲染之前调用
+    bool addSlotBefore(std::string_view marker, const std::string& name);
+
+    // 插槽序号，同名的插槽共用一个序号；不存在时返回 -1。应在编译后取得一次，渲染时按序号填值
+    int slotIndex(std::string_view name) const;
+
+    size_t slotCount() const
+    { return slotNames_.size(); }
+
+    // 按插槽序号给出各插槽的值，结果作为 resp 的响应体并设置 Content-Length，缺少的值按空串处理
+    void render(std::vector<std::string> values, HttpResponse* resp) const;
+
+private:
+    explicit HtmlTemplate(std::string text)
+        : text_(std::move(text))
+    {}
+
+    struct Piece
+    {
+        size_t offset; // 静态片段在 text_ 中的位置
+        size_t length;
+        int    slot; // 插槽序号，静态片段为 -1
+    };
+
+    int addSlot(std::string_view name);
+
+    std::string              text_; // 页面原文，静态片段直接引用其中的内容
+    std::vector<Piece>       pieces_;
+    std::vector<std::string> slotNames_;
+};
+
+using HtmlTemplatePtr = std::shared_ptr<const HtmlTemplate>;
+
+} // namespace http
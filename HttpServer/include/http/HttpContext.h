@@ -1,10 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include <muduo/net/TcpServer.h>
 
 #include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "HttpScanner.h"
+#include "TimingWheel.h"
+
+namespace ssl
+{
+class SslConnection;
+} // namespace ssl
 
 namespace http
 {
@@ -17,22 +29,54 @@ public:
         kExpectRequestLine, // 解析请求行
         kExpectHeaders, // 解析请求头
         kExpectBody, // 解析请求体
+        kExpectChunkSize, // 解析分块大小行
+        kExpectChunkData, // 解析分块数据
+        kExpectChunkCRLF, // 解析分块数据后的CRLF
+        kExpectChunkTrailers, // 解析结束块后的trailer
         kGotAll, // 解析完成
     };
     
     HttpContext()
     : state_(kExpectRequestLine)
+    , slab_(std::make_shared<RequestSlab>())
     {}
 
+    // 单个分块大小行（含扩展）的最大长度
+    static const size_t kMaxChunkLineLength = 1024;
+
     bool parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime);
     bool gotAll() const 
     { return state_ == kGotAll;  }
 
+    // 解析失败时应返回的状态码（400/413/431/501）
+    HttpResponse::HttpStatusCode errorStatus() const
+    { return errorStatus_; }
+
+    // 请求体（Content-Length 或分块解码后）的最大长度，超过时返回 413
+    void setMaxBodySize(size_t size)
+    { maxBodySize_ = size; }
+
+    // 请求行和请求头（含结束的空行）的最大长度，超过时返回 431；扫描范围也以此为限
+    void setMaxHeaderSize(size_t size)
+    { maxHeaderSize_ = std::min<size_t>(size, UINT32_MAX); }
+
     void reset()
     {
         state_ = kExpectRequestLine;
-        HttpRequest dummyData;
-        request_.swap(dummyData);
+        chunkRemaining_ = 0;
+        errorStatus_ = HttpResponse::k400BadRequest;
+        scanState_.reset();
+        request_.reset();
+        // 输入区仍被某个请求副本引用时另起一块，否则清空后复用已分配的内存
+        if (slab_.use_count() > 1)
+        {
+            slab_ = std::make_shared<RequestSlab>();
+        }
+        else
+        {
+            slab_->head.clear();
+            slab_->body.clear();
+        }
     }
 
     const HttpRequest& request() const
@@ -41,11 +85,162 @@ public:
     HttpRequest& request()
     { return request_;}
 
+    // 本连接的响应队列，流水线请求的响应按请求顺序追加，一批处理完后一次性发送
+    muduo::net::Buffer* outputQueue()
+    { return &outputQueue_; }
+
+    // 排在响应队列当前末尾之后的共享响应体（文件映射、静态资源），发送时在该位置直接写出
+    struct QueuedBody
+    {
+        size_t                   offset; // 响应体在响应队列中的插入位置
+        HttpResponse::SharedBody body;
+    };
+
+    void queueBody(const HttpResponse::SharedBody& body)
+    { queuedBodies_.push_back({outputQueue_.readableBytes(), body}); }
+
+    std::vector<QueuedBody>& queuedBodies()
+    { return queuedBodies_; }
+
+    // 开始分块发送一个响应，发送期间暂停处理input中后续的流水线请求
+    void startStream(HttpResponse::ChunkProducer producer, bool chunked, bool close,
+                     muduo::net::Buffer* input)
+    {
+        streamProducer_ = std::move(producer);
+        streamChunked_ = chunked;
+        streamClose_ = close;
+        pendingInput_ = input;
+    }
+
+    bool streaming() const
+    { return static_cast<bool>(streamProducer_); }
+
+    // 生成下一段响应体追加到响应队列，响应体全部写出后返回false并结束分块发送
+    bool produceChunk()
+    {
+        HttpResponse::ChunkWriter writer(&outputQueue_, streamChunked_);
+        bool more = true;
+        // 生成器可能某次什么都没写，需要继续调用，否则不会再有写完成回调驱动
+        while (more && outputQueue_.readableBytes() == 0)
+        {
+            more = streamProducer_(&writer);
+        }
+        if (!more)
+        {
+            writer.finish();
+            streamProducer_ = nullptr;
+        }
+        return more;
+    }
+
+    bool streamClose() const
+    { return streamClose_; }
+
+    // 等待延迟响应完成，期间暂停处理input中后续的流水线请求
+    void startDeferred(muduo::net::Buffer* input)
+    {
+        awaitingDeferred_ = true;
+        pendingInput_ = input;
+    }
+
+    void finishDeferred()
+    { awaitingDeferred_ = false; }
+
+    // 是否有尚未发送完的响应，此时后续请求留在输入缓冲区中等待
+    bool busy() const
+    { return streaming() || awaitingDeferred_; }
+
+    muduo::net::Buffer* pendingInput() const
+    { return pendingInput_; }
+
+    // 本连接的 TLS 状态，未启用 SSL 时为空
+    void setSslConnection(std::shared_ptr<ssl::SslConnection> sslConn)
+    { sslConn_ = std::move(sslConn); }
+
+    ssl::SslConnection* sslConnection() const
+    { return sslConn_.get(); }
+
+    // 是否正在读一个请求的请求行和请求头（已收到部分数据）
+    bool readingHeaders(const muduo::net::Buffer* input) const
+    { return state_ == kExpectRequestLine && input && input->readableBytes() > 0; }
+
+    // 是否正在读请求体
+    bool readingBody() const
+    { return state_ != kExpectRequestLine && state_ != kGotAll; }
+
+    // 本连接已处理的请求数
+    int requestCount() const
+    { return requestCount_; }
+
+    int countRequest()
+    { return ++requestCount_; }
+
+    // 本连接当前期限对应的阶段，由服务器根据读请求的进度设置
+    enum TimeoutPhase
+    {
+        kNoTimeout,
+        kHeaderTimeout, // 读请求行和请求头，期限从请求开始计算
+        kBodyTimeout, // 读请求体，期限为两次收到数据的最长间隔
+        kIdleTimeout, // 两个请求之间的空闲
+    };
+
+    // 本连接在所属 IO 线程时间轮中的表项，未安装时间轮时为空
+    void setTimeout(TimingWheel* wheel, TimingWheel::EntryPtr entry)
+    {
+        timeoutWheel_ = wheel;
+        timeout_ = std::move(entry);
+    }
+
+    TimingWheel* timeoutWheel() const
+    { return timeoutWheel_; }
+
+    const TimingWheel::EntryPtr& timeout() const
+    { return timeout_; }
+
+    TimeoutPhase timeoutPhase() const
+    { return timeoutPhase_; }
+
+    // 记录进入的阶段及当时已处理的请求数，用于判断请求头期限是否属于同一个请求
+    void setTimeoutPhase(TimeoutPhase phase)
+    {
+        timeoutPhase_ = phase;
+        timeoutRequest_ = requestCount_;
+    }
+
+    bool timeoutForCurrentRequest() const
+    { return timeoutRequest_ == requestCount_; }
+
 private:
     bool processRequestLine(const char* begin, const char* end);
+    bool processHeaders(const char* base);
+    bool processBodyFraming();
+    bool fail(HttpResponse::HttpStatusCode status)
+    {
+        errorStatus_ = status;
+        return false;
+    }
 private:
-    HttpRequestParseState state_;
-    HttpRequest           request_;
+    HttpRequestParseState        state_;
+    HttpRequest                  request_;
+    std::shared_ptr<RequestSlab> slab_; // 本连接的请求输入区
+    HttpScanner::State           scanState_; // 请求头扫描进度
+    uint64_t                     chunkRemaining_ = 0; // 当前分块剩余的数据长度
+    size_t                       maxBodySize_ = 64 * 1024 * 1024; // 请求体的最大长度
+    size_t                       maxHeaderSize_ = 16 * 1024; // 请求头的最大长度
+    HttpResponse::HttpStatusCode errorStatus_ = HttpResponse::k400BadRequest; // 解析失败时的状态码
+    muduo::net::Buffer           outputQueue_; // 待发送的响应
+    std::vector<QueuedBody>      queuedBodies_; // 待发送的共享响应体，按插入位置排列
+    HttpResponse::ChunkProducer  streamProducer_; // 正在分块发送的响应体生成器
+    bool                         streamChunked_ = true; // 是否使用分块编码（HTTP/1.0 直接写出原始数据）
+    bool                         streamClose_ = false; // 发送完成后是否关闭连接
+    bool                         awaitingDeferred_ = false; // 是否在等待延迟响应完成
+    muduo::net::Buffer*          pendingInput_ = nullptr; // 暂停处理的请求输入缓冲区
+    std::shared_ptr<ssl::SslConnection> sslConn_; // 本连接的 SSL 连接，随连接上下文一起由所属 IO 线程访问
+    int                          requestCount_ = 0; // 已处理的请求数
+    TimingWheel*                 timeoutWheel_ = nullptr; // 所属 IO 线程的时间轮
+    TimingWheel::EntryPtr        timeout_; // 本连接在时间轮中的表项
+    TimeoutPhase                 timeoutPhase_ = kNoTimeout;
+    int                          timeoutRequest_ = 0; // 进入当前阶段时已处理的请求数
 };
 
 } // namespace http
\ No newline at end of file
@@ -1,14 +1,44 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <muduo/base/Timestamp.h>
 
 namespace http
 {
 
+// 按 ASCII 忽略大小写比较，用于请求头名称等大小写不敏感的字段
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        char x = a[i], y = b[i];
+        if (x != y && ((x | 0x20) != (y | 0x20) || (x | 0x20) < 'a' || (x | 0x20) > 'z'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 每个连接一份的请求输入区，HttpRequest 中的字段以 string_view 的形式引用其中的数据，
+// 在响应发送之前由 HttpRequest 持有引用计数保证不会被复用或释放
+struct RequestSlab
+{
+    std::string head; // 请求行 + 请求头
+    std::string body; // 请求体
+};
+
 class HttpRequest
 {
 public:
@@ -16,74 +46,117 @@ public:
     {
         kInvalid, kGet, kPost, kHead, kPut, kDelete, kOptions
     };
-    
+
+    using Header = std::pair<std::string_view, std::string_view>;
+
+    // 常用请求头在解析时记录到固定的槽位，按槽位取值不需要查找
+    enum KnownHeader
+    {
+        kHost,
+        kCookie,
+        kContentType,
+        kContentLength,
+        kConnection,
+        kAcceptEncoding,
+        kKnownHeaderCount,
+    };
+
     HttpRequest()
         : method_(kInvalid)
         , version_("Unknown")
     {
     }
-    
+
+    // 绑定请求所引用的输入区
+    void setSlab(std::shared_ptr<const RequestSlab> slab)
+    { slab_ = std::move(slab); }
+
     void setReceiveTime(muduo::Timestamp t);
     muduo::Timestamp receiveTime() const { return receiveTime_; }
-    
+
     bool setMethod(const char* start, const char* end);
     Method method() const { return method_; }
 
     void setPath(const char* start, const char* end);
-    std::string path() const { return path_; }
+    void setPath(const std::string& path);
+    std::string_view path() const
+    { return pathOwned_ ? std::string_view(ownedPath_) : path_; }
 
     void setPathParameters(const std::string &key, const std::string &value);
     std::string getPathParameters(const std::string &key) const;
 
     void setQueryParameters(const char* start, const char* end);
-    std::string getQueryParameters(const std::string &key) const;
-    
+    std::string_view getQueryParameters(std::string_view key) const;
+
     void setVersion(std::string v)
     {
         version_ = v;
     }
 
-    std::string getVersion() const
+    const std::string& getVersion() const
     {
         return version_;
     }
-    
+
     void addHeader(const char* start, const char* colon, const char* end);
-    std::string getHeader(const std::string& field) const;
 
-    const std::map<std::string, std::string>& headers() const
+    // 请求头名称不区分大小写，同名请求头取第一个，不存在时返回空
+    std::string_view getHeader(std::string_view field) const;
+
+    std::string_view getHeader(KnownHeader header) const
+    { return knownHeaders_[header]; }
+
+    // 常用请求头的槽位，不是常用请求头时返回 kKnownHeaderCount
+    static KnownHeader knownHeaderOf(std::string_view field);
+
+    const std::vector<Header>& headers() const
     { return headers_; }
 
-    void setBody(const std::string& body) { content_ = body; }
-    void setBody(const char* start, const char* end) 
-    { 
-        if (end >= start) 
+    // 由处理器改写的请求体才会物化为 std::string
+    void setBody(const std::string& body)
+    {
+        ownedBody_ = body;
+        bodyOwned_ = true;
+    }
+    void setBody(const char* start, const char* end)
+    {
+        if (end >= start)
         {
-            content_.assign(start, end - start); 
+            body_ = std::string_view(start, end - start);
+            bodyOwned_ = false;
         }
     }
-    
-    std::string getBody() const
-    { return content_; }
+
+    std::string_view getBody() const
+    { return bodyOwned_ ? std::string_view(ownedBody_) : body_; }
 
     void setContentLength(uint64_t length)
     { contentLength_ = length; }
-    
+
     uint64_t contentLength() const
     { return contentLength_; }
 
+    // 清空请求，保留各容器已分配的容量以便复用
+    void reset();
+
     void swap(HttpRequest& that);
 
 private:
     Method                                       method_; // 请求方法
     std::string                                  version_; // http版本
-    std::string                                  path_; // 请求路径
+    std::string_view                             path_; // 请求路径
     std::unordered_map<std::string, std::string> pathParameters_; // 路径参数
-    std::unordered_map<std::string, std::string> queryParameters_; // 查询参数
+    std::vector<Header>                          queryParameters_; // 查询参数
     muduo::Timestamp                             receiveTime_; // 接收时间
-    std::map<std::string, std::string>           headers_; // 请求头
-    std::string                                  content_; // 请求体
+    std::vector<Header>                          headers_; // 请求头，键值均引用输入区
+    std::string_view                             knownHeaders_[kKnownHeaderCount]; // 常用请求头的值
+    std::string_view                             body_; // 请求体
     uint64_t                                     contentLength_ { 0 }; // 请求体长度
-};  
+    std::shared_ptr<const RequestSlab>           slab_; // 字段引用的输入区
+    std::string                                  ownedPath_; // 被改写后的请求路径
+    std::string                                  ownedBody_; // 被改写后的请求体
+    bool                                         pathOwned_ { false };
+    bool                                         bodyOwned_ { false };
+};
 
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -1,10 +1,21 @@
 #pragma once
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include <muduo/net/TcpServer.h>
 
+#include "../utils/FileCache.h"
+
 namespace http
 {
 
+class ResponseWriter;
+
 class HttpResponse 
 {
 public:
@@ -14,19 +25,49 @@ public:
         k200Ok = 200,
         k204NoContent = 204,
         k301MovedPermanently = 301,
+        k304NotModified = 304,
         k400BadRequest = 400,
         k401Unauthorized = 401,
         k403Forbidden = 403,
         k404NotFound = 404,
         k405MethodNotAllowed = 405,
         k409Conflict = 409,
+        k413PayloadTooLarge = 413,
+        k431RequestHeaderFieldsTooLarge = 431,
         k500InternalServerError = 500,
+        k501NotImplemented = 501,
+    };
+
+    // 分块写出响应体，HTTP/1.0 客户端不支持分块编码，此时直接写出原始数据
+    class ChunkWriter
+    {
+    public:
+        ChunkWriter(muduo::net::Buffer* output, bool chunked)
+            : output_(output)
+            , chunked_(chunked)
+        {}
+
+        void write(const char* data, size_t len);
+        void write(const std::string& data)
+        { write(data.data(), data.size()); }
+
+        // 写出结束块
+        void finish();
+
+    private:
+        muduo::net::Buffer* output_;
+        bool                chunked_;
     };
 
+    // 响应体生成器，每次调用写出一部分响应体，返回false表示响应体已全部写出
+    using ChunkProducer = std::function<bool (ChunkWriter* writer)>;
+
     HttpResponse(bool close = true)
         : statusCode_(kUnknown)
         , closeConnection_(close)
-    {}
+    {
+        headers_.reserve(kHeaderReserve);
+    }
 
     void setVersion(std::string version)
     { httpVersion_ = version; }
@@ -51,30 +92,126 @@ public:
     void setContentLength(uint64_t length)
     { addHeader("Content-Length", std::to_string(length)); }
 
-    void addHeader(const std::string& key, const std::string& value)
-    { headers_[key] = value; }
+    // 同名响应头覆盖原值
+    void addHeader(const std::string& key, const std::string& value);
+
+    // 已设置的响应头，不存在时返回空指针
+    const std::string* findHeader(std::string_view key) const;
     
     void setBody(const std::string& body)
     { 
+        bodySegments_.clear();
         body_ = body;
         // body_ += "\0";
     }
 
+    // 共享的只读响应体段：服务器发送时直接从 data 写出，不拷贝进 body_ 和响应队列
+    // owner 保证数据在发送完成前有效
+    struct SharedBody
+    {
+        std::shared_ptr<const void> owner;
+        const char*                 data = nullptr;
+        size_t                      size = 0;
+    };
+
+    // 以一段共享数据作为响应体，同时设置 Content-Length
+    void setSharedBody(std::shared_ptr<const void> owner, const char* data, size_t size)
+    {
+        clearBody();
+        appendBodySegment(std::move(owner), data, size);
+        setContentLength(size);
+    }
+
+    // 追加一段共享数据，响应体由各段依次组成（如模板的静态片段与插值），Content-Length 由调用者设置
+    void appendBodySegment(std::shared_ptr<const void> owner, const char* data, size_t size)
+    { bodySegments_.push_back(SharedBody{std::move(owner), data, size}); }
+
+    // 以文件作为响应体，直接从文件的只读映射发送
+    void setFileBody(MappedFilePtr file)
+    {
+        const char* data = file->data();
+        size_t size = file->size();
+        setSharedBody(std::move(file), data, size);
+    }
+
+    const std::vector<SharedBody>& bodySegments() const
+    { return bodySegments_; }
+
+    void clearBody()
+    {
+        body_.clear();
+        bodySegments_.clear();
+    }
+
+    // 以分块方式发送响应体，服务器写出响应头后在连接可写时反复调用生成器，
+    // 响应体不必一次性生成，每个连接只占用一块数据的内存
+    void setChunkedBody(ChunkProducer producer)
+    { chunkProducer_ = std::move(producer); }
+
+    // 延迟响应：处理器取得 ResponseWriter 后可立即返回，之后在任意线程完成响应，
+    // 此前写入本对象的状态（如 Set-Cookie）会转移到 ResponseWriter 持有的响应中
+    std::shared_ptr<ResponseWriter> defer();
+
+    bool isDeferred() const
+    { return deferred_; }
+
+    // 由服务器设置，创建绑定到当前连接的 ResponseWriter
+    using DeferHook = std::function<std::shared_ptr<ResponseWriter> (HttpResponse* response)>;
+    void setDeferHook(DeferHook hook)
+    { deferHook_ = std::move(hook); }
+
+    // defer() 之后本对象会被移走，持有本对象指针的一方（如会话的 Set-Cookie 回调）
+    // 通过监听器改为写入 ResponseWriter 持有的响应；未 defer 时监听器不会被调用
+    using DeferListener = std::function<void (const std::shared_ptr<ResponseWriter>& writer)>;
+    void addDeferListener(DeferListener listener)
+    { deferListeners_.push_back(std::move(listener)); }
+
+    // 响应写入连接的响应队列后由服务器调用，之后本对象随时会被销毁，持有其指针的一方须停止写入
+    // 未 defer 时在处理函数返回后调用；defer 后监听器随响应一起转移，在 done() 之后调用
+    using WrittenListener = std::function<void ()>;
+    void addWrittenListener(WrittenListener listener)
+    { writtenListeners_.push_back(std::move(listener)); }
+
+    void notifyWritten();
+
+    bool isChunked() const
+    { return static_cast<bool>(chunkProducer_); }
+
+    ChunkProducer& chunkProducer()
+    { return chunkProducer_; }
+
     void setStatusLine(const std::string& version,
                          HttpStatusCode statusCode,
                          const std::string& statusMessage);
 
     void setErrorHeader(){}
 
+    // 序列化完整的响应（不含共享响应体段）
     void appendToBuffer(muduo::net::Buffer* outputBuf) const;
+
+    // 只序列化状态行和响应头（以空行结束），响应体由调用者另行发送
+    void appendHeadersToBuffer(muduo::net::Buffer* outputBuf) const;
+
+    // 把 body_ 转为第一个共享响应体段，之后整个响应体都可以不经拷贝直接发送
+    void shareBody();
+
+    size_t bodySize() const
+    { return body_.size(); }
 private:
+    static const size_t kHeaderReserve = 8; // 预留的响应头个数，常见响应不需要再扩容
+
     std::string                        httpVersion_; 
     HttpStatusCode                     statusCode_;
     std::string                        statusMessage_;
     bool                               closeConnection_;
-    std::map<std::string, std::string> headers_;
+    std::vector<std::pair<std::string, std::string>> headers_; // 响应头很少，按设置顺序连续存放，线性查找
     std::string                        body_;
-    bool                               isFile_;
+    std::vector<SharedBody>            bodySegments_; // 共享的只读响应体段，位于 body_ 之后
+    ChunkProducer                      chunkProducer_; // 分块发送的响应体生成器
+    DeferHook                          deferHook_;
+    std::vector<DeferListener>         deferListeners_;
+    std::vector<WrittenListener>       writtenListeners_;
+    bool                               deferred_ = false; // 是否已转为延迟响应
 };
 
 } // namespace http
\ No newline at end of file
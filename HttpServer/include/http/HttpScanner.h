@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace http
+{
+
+// 请求头分隔符扫描器
+// 一次遍历同时找出请求头中所有的行尾(CRLF)和每行第一个冒号，
+// 运行时根据CPU能力选择 AVX2 / SSE2 实现，其他平台退化为逐字节扫描
+class HttpScanner
+{
+public:
+    static const uint32_t kNoColon = UINT32_MAX;
+
+    // 一行的位置，均为相对请求头起始处的偏移
+    struct Line
+    {
+        uint32_t begin; // 行首
+        uint32_t colon; // 第一个冒号，没有冒号时为 kNoColon
+        uint32_t end;   // 行尾的 '\r'
+    };
+
+    // 扫描进度，请求头分多次到达时从上次停下的位置继续扫描
+    struct State
+    {
+        uint32_t          scanned = 0; // 已扫描的字节数
+        uint32_t          lineBegin = 0; // 当前行的行首
+        uint32_t          colon = kNoColon; // 当前行的第一个冒号
+        std::vector<Line> lines; // 已扫描完的行（请求行 + 请求头）
+
+        void reset()
+        {
+            scanned = 0;
+            lineBegin = 0;
+            colon = kNoColon;
+            lines.clear();
+        }
+    };
+
+    // 从 state->scanned 处继续扫描 [data, data + len)，偏移为 32 位，调用方需把 len 限制在请求头上限内
+    // 遇到空行时返回请求头总长度（含结束请求头的空行），否则返回0
+    static size_t scanHead(const char* data, size_t len, State* state);
+
+    // 当前使用的实现名称
+    static const char* implName();
+};
+
+} // namespace http
@@ -6,23 +6,26 @@
 
 #include <functional>
 #include <iostream>
-#include <map>
 #include <memory>
 #include <unordered_map>
 
 #include <muduo/net/TcpServer.h>
 #include <muduo/net/EventLoop.h>
 #include <muduo/base/Logging.h>
+#include <muduo/base/ThreadPool.h>
 
 #include "HttpContext.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "ResponseWriter.h"
+#include "StaticAssetCache.h"
 #include "../router/Router.h"
 #include "../session/SessionManager.h"
 #include "../middleware/MiddlewareChain.h"
 #include "../middleware/cors/CorsMiddleware.h"
 #include "../ssl/SslConnection.h"
 #include "../ssl/SslContext.h"
+#include "../utils/FileCache.h"
 
 class HttpRequest;
 class HttpResponse;
@@ -34,6 +37,8 @@ class HttpServer : muduo::noncopyable
 {
 public:
     using HttpCallback = std::function<void (const http::HttpRequest&, http::HttpResponse*)>;
+    // 服务器内部的请求分发函数，请求在分发期间可以原地修改（中间件、路径参数）
+    using RequestDispatcher = std::function<void (http::HttpRequest&, http::HttpResponse*)>;
     
     // 构造函数
     HttpServer(int port,
@@ -46,6 +51,55 @@ public:
         server_.setThreadNum(numThreads);
     }
 
+    // 设置处理耗时任务的工作线程数，为0时任务直接在调用线程执行
+    void setWorkerThreadNum(int numThreads)
+    {
+        workerThreadNum_ = numThreads;
+    }
+
+    // 连接超时（秒），由每个 IO 线程的时间轮检查，为0时不限制，须在 start() 之前设置
+    // keep-alive 连接两个请求之间的最长空闲时间
+    void setIdleTimeout(double seconds)
+    {
+        idleTimeout_ = seconds;
+    }
+
+    // 从收到请求的第一个字节（或建立连接）起读完请求行和请求头的期限，超时返回 408
+    void setHeaderTimeout(double seconds)
+    {
+        headerTimeout_ = seconds;
+    }
+
+    // 读请求体时两次收到数据之间的最长间隔，超时返回 408
+    void setBodyTimeout(double seconds)
+    {
+        bodyTimeout_ = seconds;
+    }
+
+    // 每个连接最多处理的请求数，达到后在最后一个响应中关闭连接，为0时不限制
+    void setMaxRequestsPerConnection(int maxRequests)
+    {
+        maxRequestsPerConnection_ = maxRequests;
+    }
+
+    // 请求体的最大长度（字节），Content-Length 或分块解码后的长度超过时返回 413 并关闭连接
+    void setMaxBodySize(size_t size)
+    {
+        maxBodySize_ = size;
+    }
+
+    // 请求行和请求头的最大总长度（字节），超过时返回 431 并关闭连接
+    void setMaxHeaderSize(size_t size)
+    {
+        maxHeaderSize_ = size;
+    }
+
+    // 将耗时任务（如配合 HttpResponse::defer() 的处理器逻辑）交给工作线程池执行
+    void runInWorker(muduo::ThreadPool::Task task)
+    {
+        workerPool_.run(std::move(task));
+    }
+
     void start();
 
     muduo::net::EventLoop* getLoop() const 
@@ -104,6 +158,18 @@ public:
         return sessionManager_.get();
     }
 
+    // 静态文件缓存，处理器通过 HttpResponse::setFileBody 发送其中的文件
+    FileCache* getFileCache()
+    {
+        return &fileCache_;
+    }
+
+    // 预压缩的静态资源缓存，须在 start() 之前加载
+    StaticAssetCache* getStaticAssets()
+    {
+        return &staticAssets_;
+    }
+
     // 添加中间件的方法
     void addMiddleware(std::shared_ptr<middleware::Middleware> middleware) 
     {
@@ -117,6 +183,18 @@ public:
 
     void setSslConfig(const ssl::SslConfig& config);
 
+    // 重新加载证书（如供管理接口调用），进行中的握手不受影响；未启用 SSL 或加载失败时返回 false
+    bool reloadCertificates()
+    {
+        return sslCtx_ && sslCtx_->reloadCertificates();
+    }
+
+    // SSL 上下文（未启用 SSL 时为空），可读取会话复用与握手统计
+    ssl::SslContext* getSslContext() const
+    {
+        return sslCtx_.get();
+    }
+
 private:
     void initialize();
 
@@ -124,22 +202,51 @@ private:
     void onMessage(const muduo::net::TcpConnectionPtr& conn,
                    muduo::net::Buffer* buf,
                    muduo::Timestamp receiveTime);
-    void onRequest(const muduo::net::TcpConnectionPtr&, const HttpRequest&);
-
-    void handleRequest(const HttpRequest& req, HttpResponse* resp);
+    void handleMessage(const muduo::net::TcpConnectionPtr& conn,
+                       muduo::net::Buffer* buf,
+                       muduo::Timestamp receiveTime);
+    void onWriteComplete(const muduo::net::TcpConnectionPtr& conn);
+    void processRequests(const muduo::net::TcpConnectionPtr& conn,
+                         HttpContext* context,
+                         muduo::net::Buffer* buf,
+                         muduo::Timestamp receiveTime);
+    bool onRequest(const muduo::net::TcpConnectionPtr& conn,
+                   HttpContext* context,
+                   muduo::net::Buffer* input);
+    void onDeferredDone(const std::weak_ptr<muduo::net::TcpConnection>& weakConn,
+                        HttpResponse* response,
+                        bool chunked);
+    void sendOutput(const muduo::net::TcpConnectionPtr& conn, HttpContext* context);
+    void updateTimeout(HttpContext* context, muduo::net::Buffer* input);
+    void armTimeout(HttpContext* context, HttpContext::TimeoutPhase phase, double seconds);
+    void onTimeout(const std::weak_ptr<muduo::net::TcpConnection>& weakConn);
+    bool writeResponse(HttpContext* context,
+                       HttpResponse* response,
+                       bool chunked,
+                       muduo::net::Buffer* input);
+
+    void handleRequest(HttpRequest& req, HttpResponse* resp);
     
 private:
     muduo::net::InetAddress                      listenAddr_; // 监听地址
     muduo::net::TcpServer                        server_; 
     muduo::net::EventLoop                        mainLoop_; // 主循环
-    HttpCallback                                 httpCallback_; // 回调函数
+    RequestDispatcher                            httpCallback_; // 回调函数
     router::Router                               router_; // 路由
     std::unique_ptr<session::SessionManager>     sessionManager_; // 会话管理器
     middleware::MiddlewareChain                  middlewareChain_; // 中间件链
     std::unique_ptr<ssl::SslContext>             sslCtx_; // SSL 上下文
     bool                                         useSSL_; // 是否使用 SSL   
-    // TcpConnectionPtr -> SslConnectionPtr 
-    std::map<muduo::net::TcpConnectionPtr, std::unique_ptr<ssl::SslConnection>> sslConns_;
+    muduo::ThreadPool                            workerPool_; // 处理耗时任务的工作线程池
+    int                                          workerThreadNum_ = 0; // 工作线程数
+    FileCache                                    fileCache_; // 静态文件缓存
+    StaticAssetCache                             staticAssets_; // 预压缩的静态资源
+    double                                       idleTimeout_ = 60; // keep-alive 空闲超时
+    double                                       headerTimeout_ = 20; // 读请求头超时
+    double                                       bodyTimeout_ = 60; // 读请求体超时
+    int                                          maxRequestsPerConnection_ = 1000; // 每个连接的最大请求数
+    size_t                                       maxBodySize_ = 64 * 1024 * 1024; // 请求体的最大长度
+    size_t                                       maxHeaderSize_ = 16 * 1024; // 请求头的最大长度
 }; 
 
 } // namespace http
\ No newline at end of file
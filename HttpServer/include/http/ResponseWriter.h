@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/EventLoop.h>
+
+#include "HttpResponse.h"
+
+namespace http
+{
+
+// 延迟响应的句柄
+// 处理器调用 HttpResponse::defer() 取得后即可返回，之后在任意线程填写 response() 并调用 done()，
+// 响应会被转回连接所属的 EventLoop 中发送
+class ResponseWriter : public std::enable_shared_from_this<ResponseWriter>,
+                       muduo::noncopyable
+{
+public:
+    // 在连接所属的 EventLoop 中执行，负责发送填写好的响应
+    using DoneCallback = std::function<void (HttpResponse* response)>;
+
+    ResponseWriter(muduo::net::EventLoop* loop, HttpResponse response, DoneCallback cb)
+        : loop_(loop)
+        , response_(std::move(response))
+        , doneCallback_(std::move(cb))
+        , done_(false)
+    {}
+
+    ~ResponseWriter();
+
+    HttpResponse* response()
+    { return &response_; }
+
+    // 完成响应，可在任意线程调用，重复调用无效
+    void done();
+
+    bool isDone() const
+    { return done_; }
+
+private:
+    muduo::net::EventLoop* loop_; // 连接所属的事件循环
+    HttpResponse           response_; // 待发送的响应
+    DoneCallback           doneCallback_;
+    std::atomic<bool>      done_;
+};
+
+using ResponseWriterPtr = std::shared_ptr<ResponseWriter>;
+
+} // namespace http
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <muduo/base/noncopyable.h>
+
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+namespace http
+{
+
+// 静态资源缓存：启动时把资源文件读入内存并预先压缩，请求时只根据 Accept-Encoding 选择已有的编码，
+// 响应体直接从缓存发送，请求路径上没有磁盘 IO 和压缩
+// 应在服务器启动前加载，之后只读
+class StaticAssetCache : muduo::noncopyable
+{
+public:
+    enum Encoding
+    {
+        kIdentity,
+        kGzip,
+        kBrotli,
+        kEncodingCount,
+    };
+
+    // 同一资源的一种编码
+    struct Variant
+    {
+        std::string body; // 为空表示该编码不比原文小，不提供
+        std::string etag; // 不同编码的内容不同，ETag 也不同
+    };
+
+    struct Asset
+    {
+        std::string contentType;
+        std::string lastModified; // HTTP 日期格式的文件修改时间
+        Variant     variants[kEncodingCount];
+    };
+
+    // 加载目录下扩展名为 extension 的普通文件，以 "目录/文件名" 为键，返回加载的文件数
+    size_t loadDirectory(const std::string& dir, const std::string& extension = ".html");
+
+    // 加载单个文件，以 path 为键，文本类型的资源同时生成 gzip 与 brotli 编码
+    bool load(const std::string& path);
+
+    std::shared_ptr<const Asset> find(const std::string& path) const;
+
+    // 用缓存的资源填写响应：条件请求命中时返回 304，否则按 Accept-Encoding 选择编码
+    // 资源不在缓存中时返回 false，响应保持不变
+    bool serve(const std::string& path, const HttpRequest& req, HttpResponse* resp) const;
+
+    // 根据 Accept-Encoding 选择编码，优先 brotli，其次 gzip，q=0 表示不接受
+    static Encoding selectEncoding(std::string_view acceptEncoding, const Asset& asset);
+
+private:
+    std::unordered_map<std::string, std::shared_ptr<const Asset>> assets_;
+};
+
+} // namespace http
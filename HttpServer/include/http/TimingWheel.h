@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/net/EventLoop.h>
+
+namespace http
+{
+
+// 每个 EventLoop 一个的哈希时间轮，管理本线程各连接的超时
+// 每个连接只有一个期限，设置或取消期限都是 O(1)：表项按到期刻度放入对应的槽，
+// 改期时不从旧槽中删除，而是增加代数使旧的记录失效，到期扫描时丢弃
+// 只在所属 EventLoop 的线程中使用
+class TimingWheel : muduo::noncopyable
+{
+public:
+    using ExpireCallback = std::function<void ()>;
+
+    // 一个连接在时间轮中的表项，由连接的上下文持有，连接销毁后时间轮中的记录自动失效
+    class Entry : muduo::noncopyable
+    {
+    public:
+        explicit Entry(ExpireCallback cb)
+            : callback_(std::move(cb))
+        {}
+
+        bool scheduled() const
+        { return deadline_ >= 0; }
+
+    private:
+        friend class TimingWheel;
+
+        ExpireCallback callback_;
+        int64_t        deadline_ = -1; // 到期的刻度，未设置期限时为 -1
+        uint64_t       generation_ = 0; // 每次改期加一
+    };
+
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    // 在 loop 所在线程调用，创建本线程的时间轮并注册定时器，之后在该线程中可通过 of(loop) 取得
+    // 时间轮保存在线程局部变量中，不占用 EventLoop::setContext
+    static void install(muduo::net::EventLoop* loop, double tickSeconds = 1.0, int slots = 64);
+
+    // loop 上安装的时间轮，需在 loop 所在线程调用，未安装时返回空
+    static TimingWheel* of(muduo::net::EventLoop* loop);
+
+    TimingWheel(double tickSeconds, int slots);
+
+    // 从现在起 seconds 秒后调用 entry 的回调，按刻度向上取整；落在同一刻度的改期不做任何事
+    void schedule(const EntryPtr& entry, double seconds);
+
+    void cancel(const EntryPtr& entry);
+
+    // 定时器每个刻度调用一次
+    void tick();
+
+private:
+    using Record = std::pair<std::weak_ptr<Entry>, uint64_t>; // 表项与放入时的代数
+
+    double                           tickSeconds_;
+    int64_t                          now_ = 0; // 当前刻度
+    std::vector<std::vector<Record>> slots_;
+    std::vector<Record>              expiring_; // 正在处理的槽，复用其容量
+};
+
+} // namespace http
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http
+{
+namespace router
+{
+
+// 压缩前缀树（radix tree）路由表，每种请求方法一棵
+// 路径模式支持：
+//   静态片段        /user/list
+//   命名参数        /user/:id        匹配一个路径段
+//   带类型约束的参数 /user/:id<int>   类型为 int 或 uuid
+//   通配            /static/*path    匹配剩余的全部路径，只能位于末尾
+// 查找时按 静态 > 参数 > 通配 的优先级逐段匹配，耗时只与路径长度有关，与路由数量无关
+class RouteTree
+{
+public:
+    enum class ParamType
+    {
+        kString,
+        kInt,
+        kUuid
+    };
+
+    // 匹配得到的路径参数，name 引用路由表，value 引用请求路径
+    using Param = std::pair<std::string_view, std::string_view>;
+    using Params = std::vector<Param>;
+
+    RouteTree();
+    ~RouteTree();
+
+    // 插入路径模式，返回该模式对应的 routeId：模式已存在时为原来的 routeId，否则为传入的 routeId
+    // 模式非法（如通配不在末尾、未知类型）时抛出 std::invalid_argument
+    int insert(const std::string& pattern, int routeId);
+
+    // 查找与 path 匹配的路由，返回插入时的 routeId，找不到返回 -1
+    int match(std::string_view path, Params* params) const;
+
+private:
+    struct Node;
+
+    static Node* insertStatic(Node* node, std::string_view path);
+    static Node* insertParam(Node* node, const std::string& name, ParamType type);
+    static bool matchNode(const Node* node, std::string_view path, Params* params, int* routeId);
+    static bool checkType(ParamType type, std::string_view value);
+
+private:
+    std::unique_ptr<Node> root_;
+};
+
+} // namespace router
+} // namespace http
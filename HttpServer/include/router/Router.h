@@ -1,12 +1,11 @@
 #pragma once
 #include <iostream>
-#include <unordered_map>
 #include <string>
 #include <memory>
 #include <functional>
-#include <regex>
 #include <vector>
 
+#include "RouteTree.h"
 #include "RouterHandler.h"
 #include "../http/HttpRequest.h"
 #include "../http/HttpResponse.h"
@@ -25,97 +24,52 @@ public:
     using HandlerPtr = std::shared_ptr<RouterHandler>;
     using HandlerCallback = std::function<void(const HttpRequest &, HttpResponse *)>;
 
-    // 路由键（请求方法 + URI）
-    struct RouteKey
-    {
-        HttpRequest::Method method;
-        std::string path;
-
-        bool operator==(const RouteKey &other) const
-        {
-            return method == other.method && path == other.path;
-        }
-    };
-
-    // 为RouteKey 定义哈希函数
-    struct RouteKeyHash
-    {
-        // size_t operator()(const RouteKey& key) const
-        // {
-        //     return std::hash<int>{}(static_cast<int>(key.method)) ^
-        //            std::hash<std::string>{}(key.path);
-        // }
-        size_t operator()(const RouteKey &key) const
-        {
-            size_t methodHash = std::hash<int>{}(static_cast<int>(key.method));
-            size_t pathHash = std::hash<std::string>{}(key.path);
-            return methodHash * 31 + pathHash;
-        }
-    };
-
     // 注册路由处理器
     void registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler);
 
     // 注册回调函数形式的处理器
     void registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback);
 
-    // 注册动态路由处理器
+    // 注册动态路由处理器，路径中可以使用 :name、:name<int>、:name<uuid> 参数和末尾的 *name 通配
+    // 静态路由与动态路由存放在同一棵前缀树中，这里与 registerHandler 等价
     void addRegexHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
     {
-        std::regex pathRegex = convertToRegex(path);
-        regexHandlers_.emplace_back(method, pathRegex, handler);
+        registerHandler(method, path, std::move(handler));
     }
 
     // 注册动态路由处理函数
     void addRegexCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
     {
-        std::regex pathRegex = convertToRegex(path);
-        regexCallbacks_.emplace_back(method, pathRegex, callback);
+        registerCallback(method, path, callback);
     }
 
-    // 处理请求
-    bool route(const HttpRequest &req, HttpResponse *resp);
+    // 处理请求，路径参数直接写入 req
+    bool route(HttpRequest &req, HttpResponse *resp);
 
 private:
-    std::regex convertToRegex(const std::string &pathPattern)
-    { // 将路径模式转换为正则表达式，支持匹配任意路径参数
-        std::string regexPattern = "^" + std::regex_replace(pathPattern, std::regex(R"(/:([^/]+))"), R"(/([^/]+))") + "$";
-        return std::regex(regexPattern);
-    }
+    struct Route
+    {
+        HandlerPtr      handler;
+        HandlerCallback callback;
+    };
 
-    // 提取路径参数
-    void extractPathParameters(const std::smatch &match, HttpRequest &request)
+    // 取得 method + path 对应的路由表项，不存在时创建
+    Route& findOrAddRoute(HttpRequest::Method method, const std::string &path);
+
+    // 提取路径参数，同时按出现顺序设置 param1..paramN 以兼容旧的按位置取参数的写法
+    void extractPathParameters(const RouteTree::Params &params, HttpRequest &request)
     {
-        // Assuming the first match is the full path, parameters start from index 1
-        for (size_t i = 1; i < match.size(); ++i)
+        for (size_t i = 0; i < params.size(); ++i)
         {
-            request.setPathParameters("param" + std::to_string(i), match[i].str());
+            std::string value(params[i].second);
+            request.setPathParameters(std::string(params[i].first), value);
+            request.setPathParameters("param" + std::to_string(i + 1), value);
         }
     }
 
 private:
-    struct RouteCallbackObj
-    {
-        HttpRequest::Method method_;
-        std::regex pathRegex_;
-        HandlerCallback callback_;
-        RouteCallbackObj(HttpRequest::Method method, std::regex pathRegex, const HandlerCallback &callback)
-            : method_(method), pathRegex_(pathRegex), callback_(callback) {}
-    };
-
-    struct RouteHandlerObj
-    {
-        HttpRequest::Method method_;
-        std::regex pathRegex_;
-        HandlerPtr handler_;
-        RouteHandlerObj(HttpRequest::Method method, std::regex pathRegex, HandlerPtr handler)
-            : method_(method), pathRegex_(pathRegex), handler_(handler) {}
-    };
-
-    std::unordered_map<RouteKey, HandlerPtr, RouteKeyHash>      handlers_;       // 精准匹配
-    std::unordered_map<RouteKey, HandlerCallback, RouteKeyHash> callbacks_; // 精准匹配
-    std::vector<RouteHandlerObj>                                regexHandlers_;     // 正则匹配
-    std::vector<RouteCallbackObj>                               regexCallbacks_;   // 正则匹配
+    RouteTree          trees_[HttpRequest::kOptions + 1]; // 每种请求方法一棵前缀树
+    std::vector<Route> routes_;                           // 前缀树中的 routeId 为此处下标
 };
 
 
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "SessionStorage.h"
+
+namespace http
+{
+namespace session
+{
+
+// 持久化的会话存储：会话在内存中的索引与 MemorySessionStorage 相同，另外记录在一个只追加的日志文件中，
+// 服务器重启后扫描日志重建会话，用户不需要重新登录
+// 日志文件通过 mmap 映射，保存与删除只在内存中登记，由后台线程定期成批序列化追加到映射中，
+// 请求路径上没有磁盘 IO；日志中的失效记录过多时后台线程重写日志
+// 会话在两次写日志之间只登记一次（会话自身的 dirty 标记），登记列表按会话ID分片加锁；
+// 只刷新过期时间的请求在过期时间比日志中推后超过 maxAge 的 1/10 时才登记
+// 写入映射的数据在进程崩溃后仍由内核写回文件，机器掉电时可能丢失最后一段时间的修改
+class PersistentSessionStorage : public SessionStorage
+{
+public:
+    // 打开（不存在时创建）日志文件并重建会话，flushInterval 为后台线程写日志的周期
+    explicit PersistentSessionStorage(const std::string& path,
+                                      std::chrono::milliseconds flushInterval = std::chrono::milliseconds(1000));
+    ~PersistentSessionStorage() override;
+
+    void save(std::shared_ptr<Session> session) override;
+    std::shared_ptr<Session> load(const std::string& sessionId) override;
+    void remove(const std::string& sessionId) override;
+    void touch(const std::shared_ptr<Session>& session) override;
+    void cleanExpiredSession() override;
+
+    // 立即把登记的修改写入日志
+    void flush();
+
+private:
+    bool open();
+    void recover();
+    void enqueue(const std::string& sessionId, std::shared_ptr<Session> session);
+    void logged(const std::string& sessionId, size_t recordSize, int64_t expiryMs);
+    void flushLoop();
+    void writePending();
+    void append(const std::string& records);
+    bool reserve(size_t size);
+    void compact();
+    void unmap();
+
+private:
+    std::string                   path_;
+    std::chrono::milliseconds     flushInterval_;
+    MemorySessionStorage          memory_; // 会话的内存索引
+    int                           fd_ = -1;
+    char*                         data_ = nullptr; // 日志文件的映射
+    size_t                        capacity_ = 0; // 映射的长度，即文件长度
+    size_t                        size_ = 0; // 日志中有效数据的长度
+    size_t                        liveBytes_ = 0; // 日志中各会话最新一条保存记录的总长度（含文件头）
+
+    // 每个会话在日志中最新一条保存记录的长度和过期时间，用于统计 liveBytes_，只由写日志的一方访问
+    struct LoggedRecord
+    {
+        size_t  size;
+        int64_t expiryMs;
+    };
+    std::unordered_map<std::string, LoggedRecord> logged_;
+
+    static const size_t kPendingShards = 16; // 须为2的幂
+
+    // 等待写入日志的修改，按登记顺序排列，会话为空表示删除
+    struct alignas(64) PendingShard
+    {
+        std::mutex                                                        mutex;
+        std::vector<std::pair<std::string, std::shared_ptr<Session>>>     entries;
+    };
+    PendingShard                  pending_[kPendingShards];
+
+    std::mutex                    writeMutex_; // 串行化对日志文件的写入（后台线程与 flush()）
+    std::mutex                    stopMutex_;
+    std::condition_variable       stopCond_;
+    bool                          stopping_ = false;
+    std::thread                   flushThread_;
+};
+
+} // namespace session
+} // namespace http
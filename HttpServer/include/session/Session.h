@@ -3,7 +3,10 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <mutex>
 
 namespace http
 {
@@ -13,6 +16,7 @@ namespace session
 
 class SessionManager;
 
+// 同一会话可能被多个 IO 线程同时访问，数据和过期时间由会话自己的锁保护
 class Session : public std::enable_shared_from_this<Session>
 {
 public:
@@ -24,23 +28,61 @@ public:
     bool isExpired() const;
     void refresh(); // 刷新过期时间
 
+    std::chrono::system_clock::time_point getExpiryTime() const;
+
+    int getMaxAge() const
+    { return maxAge_; }
+
+    // 全部数据的副本，供持久化存储序列化
+    std::unordered_map<std::string, std::string> getData() const;
+
+    // 用持久化存储中的数据恢复会话
+    void restore(std::unordered_map<std::string, std::string> data,
+                 std::chrono::system_clock::time_point expiryTime);
+
+    // 供持久化存储使用：标记有尚未写入日志的修改，返回此前是否没有标记（即需要登记）
+    bool markDirty()
+    { return !dirty_.exchange(true, std::memory_order_acq_rel); }
+
+    void clearDirty()
+    { dirty_.store(false, std::memory_order_release); }
+
+    // 日志中记录的过期时间（毫秒），过期时间只推后一点时不必重新写入
+    int64_t persistedExpiry() const
+    { return persistedExpiry_.load(std::memory_order_relaxed); }
+
+    void setPersistedExpiry(int64_t expiryMs)
+    { persistedExpiry_.store(expiryMs, std::memory_order_relaxed); }
+
     void setManager(SessionManager* sessionManager) 
     { sessionManager_ = sessionManager; }
 
     SessionManager* getManager() const 
     { return sessionManager_; }
 
+    // 数据修改后的回调，设置后代替管理器的 updateSession（签名 cookie 模式下用来重新签发 cookie）
+    using ChangeCallback = std::function<void (Session&)>;
+    void setChangeCallback(ChangeCallback cb)
+    { changeCallback_ = std::move(cb); }
+
     // 数据存取
     void setValue(const std::string&key, const std::string&value);
     std::string getValue(const std::string&key) const;
     void remove(const std::string&key);
     void clear();
+private:
+    void notifyChanged();
+
 private:
     std::string                                  sessionId_;
     std::unordered_map<std::string, std::string> data_;
     std::chrono::system_clock::time_point        expiryTime_;
     int                                          maxAge_; // 过期时间（秒）
     SessionManager*                              sessionManager_;
+    ChangeCallback                               changeCallback_;
+    mutable std::mutex                           mutex_; // 保护 data_ 和 expiryTime_
+    std::atomic<bool>                            dirty_{false};
+    std::atomic<int64_t>                         persistedExpiry_{0};
 };
 
 } // namespace session
@@ -0,0 +1,55 @@
+#pragma once
+#include <muduo/base/noncopyable.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http
+{
+namespace session
+{
+
+// 签名 cookie 的编解码：载荷用 HMAC-SHA256 签名（可选 AES-256-CTR 加密，先加密后签名），
+// 编码为 base64url 放进 cookie。密钥由配置的密钥串派生，持有相同密钥串的进程和主机
+// 无需通信即可互相校验，任何一个 worker 都能处理任何用户的请求
+// 密钥环整体不可变，轮换时原子替换，校验路径不加锁
+class SessionCookieCodec : muduo::noncopyable
+{
+public:
+    // secrets 中第一个密钥用于签发，其余只用于校验（轮换期间旧 cookie 仍然有效）
+    explicit SessionCookieCodec(const std::vector<std::string>& secrets, bool encrypt = false,
+                                size_t maxRetiredKeys = 2);
+
+    // 换用新的签发密钥，原来的签发密钥转为只校验，只校验的密钥最多保留 maxRetiredKeys 个
+    void rotate(const std::string& secret);
+
+    std::string encode(std::string_view payload) const;
+
+    // 校验并解出载荷，签名不符或格式错误返回 false；isCurrent 为 false 时 cookie 由旧密钥签发，应重新签发
+    bool decode(std::string_view token, std::string* payload, bool* isCurrent = nullptr) const;
+
+private:
+    struct Key
+    {
+        unsigned char id[4];       // 写入 cookie 的密钥标识
+        unsigned char macKey[32];  // HMAC-SHA256 密钥
+        unsigned char encKey[32];  // AES-256-CTR 密钥
+    };
+
+    struct KeyRing
+    {
+        ~KeyRing();
+        std::vector<Key> keys; // 签发密钥在前
+    };
+
+    static Key derive(const std::string& secret);
+
+private:
+    bool                            encrypt_;
+    size_t                          maxRetiredKeys_;
+    std::shared_ptr<const KeyRing>  keys_; // 通过 std::atomic_load/atomic_store 访问
+};
+
+} // namespace session
+} // namespace http
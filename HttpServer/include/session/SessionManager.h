@@ -1,10 +1,10 @@
 #pragma once
 
 #include "SessionStorage.h"
+#include "SessionCookieCodec.h"
 #include "../http/HttpRequest.h"
 #include "../http/HttpResponse.h"
 #include <memory>
-#include <random>
 #include <mutex>
 namespace http
 {
@@ -16,29 +16,52 @@ class SessionManager
 public:
     explicit SessionManager(std::unique_ptr<SessionStorage> storage);
 
+    // 签名 cookie 模式：会话数据整体保存在客户端的 cookie 中，读取会话只需一次签名校验，
+    // 服务端不保存任何会话状态。适合只存少量数据（如登录信息）的会话，cookie 不超过约 4KB
+    // 会话数据要在响应完成之前修改（defer 后在 done() 之前），修改结果写入本次响应的 Set-Cookie；
+    // 已签发的 cookie 无法在服务端撤销，注销时清空会话数据即可让客户端删除 cookie
+    explicit SessionManager(std::shared_ptr<SessionCookieCodec> codec);
+
+    bool isCookieMode() const
+    { return codec_ != nullptr; }
+
     // 从请求中获取或创建会话
     std::shared_ptr<Session> getSession(const HttpRequest& req, HttpResponse* resp);
     
      // 销毁会话
     void destroySession(const std::string& sessionId);
 
-    // 清理过期会话
+    // 清理过期会话，由 HttpServer 的定时器周期性调用
     void cleanExpiredSessions();
 
     // 更新会话
     void updateSession(std::shared_ptr<Session> session)
     {
-        storage_->save(session);
+        if (storage_)
+        {
+            storage_->save(session);
+        }
     }
 private:
     std::string generateSessionId();
     std::string getSessionIdFromCookie(const HttpRequest& req);
     void setSessionCookie(const std::string& sessionId, HttpResponse* resp);
 
+    std::shared_ptr<Session> getCookieSession(const HttpRequest& req, HttpResponse* resp);
+    void setSignedCookie(Session& session, HttpResponse* resp);
+
+    // 签名 cookie 的写入目标：defer 之前是处理函数拿到的响应，之后是 ResponseWriter 持有的响应，
+    // 响应写出后两者都为空；保留的会话可能在其他线程修改，由 mutex 保护
+    struct CookieTarget
+    {
+        std::mutex                    mutex;
+        HttpResponse*                 response;
+        std::weak_ptr<ResponseWriter> writer;
+    };
+
 private:
     std::unique_ptr<SessionStorage> storage_;
-    std::mt19937 rng_; // 用于生成随机会话id
-    mutable std::mutex rng_mutex_;
+    std::shared_ptr<SessionCookieCodec> codec_; // 非空时为签名 cookie 模式
 };
 
 } // namespace session
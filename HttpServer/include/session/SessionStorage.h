@@ -1,8 +1,15 @@
 #pragma once
 #include "Session.h"
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 namespace http
 {
 namespace session
@@ -15,10 +22,16 @@ public:
     virtual void save(std::shared_ptr<Session> session) = 0;
     virtual std::shared_ptr<Session> load(const std::string& sessionId) = 0;
     virtual void remove(const std::string& sessionId) = 0;
+    // 已保存的会话刷新了过期时间，数据没有变化；内存存储中会话对象本身就是最新的，无需处理
+    virtual void touch(const std::shared_ptr<Session>& session)
+    { (void)session; }
+    // 由服务器的定时器周期性调用，请求路径上只在 load 时检查单个会话是否过期
     virtual void cleanExpiredSession() = 0;
 };
 
 // 基于内存的会话存储实现
+// 按会话ID的散列分成多个分片，各分片有自己的读写锁，查找只加共享锁，不同分片之间互不影响
+// 会话对象保存后修改自身数据只需会话自己的锁，不再进入索引
 class MemorySessionStorage : public SessionStorage
 {
 public:
@@ -26,9 +39,28 @@ public:
     std::shared_ptr<Session> load(const std::string& sessionId) override;
     void remove(const std::string& sessionId) override;
     void cleanExpiredSession() override;
+
+    // 依次访问所有会话（含尚未清理的过期会话），回调在分片锁之外执行
+    void forEachSession(const std::function<void (const std::shared_ptr<Session>&)>& f) const;
 private:
-    std::unordered_map<std::string, std::shared_ptr<Session>> sessions_;
-    mutable std::mutex mutex_;
+    using Clock = std::chrono::system_clock;
+    using ExpiryEntry = std::pair<Clock::time_point, std::string>; // 入堆时的过期时间与会话ID
+
+    static const size_t kShardCount = 16; // 分片数，须为2的幂
+
+    // 分片按缓存行对齐，避免相邻分片的锁互相干扰
+    struct alignas(64) Shard
+    {
+        std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+        // 按过期时间排列的最小堆，会话刷新后不更新堆，出堆时发现未过期再按新的过期时间入堆
+        std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiryHeap;
+        mutable std::shared_mutex mutex;
+    };
+
+    Shard& shardOf(const std::string& sessionId)
+    { return shards_[std::hash<std::string>()(sessionId) & (kShardCount - 1)]; }
+
+    Shard shards_[kShardCount];
 };
 
 } // namespace session
@@ -0,0 +1,48 @@
+#pragma once
+#include <muduo/base/noncopyable.h>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace ssl
+{
+
+// 会话票据密钥环
+// 时间按轮换周期划分为 epoch，每个 epoch 的密钥由主密钥 HMAC 派生：
+// 同一主密钥的多个进程（如 SO_REUSEPORT 的多个 worker）无需通信即可互相解密票据。
+// 当前 epoch 的密钥用于签发，之前仍在票据有效期内的 epoch 只用于解密
+class SessionTicketKeys : muduo::noncopyable
+{
+public:
+    struct Key
+    {
+        unsigned char name[16];    // 写入票据的密钥名
+        unsigned char aesKey[32];  // AES-256-CBC 加密密钥
+        unsigned char hmacKey[32]; // HMAC-SHA256 完整性密钥
+        int64_t       epoch;
+    };
+
+    // secret 为空时随机生成主密钥（仅本进程可用）
+    SessionTicketKeys(const std::string& secret, int rotationSeconds, int lifetimeSeconds);
+    ~SessionTicketKeys();
+
+    // 当前用于签发票据的密钥
+    Key current();
+
+    // 按密钥名查找可用于解密的密钥，isCurrent 为 false 时票据需要用新密钥重新签发
+    bool find(const unsigned char* name, Key* key, bool* isCurrent);
+
+private:
+    Key derive(int64_t epoch) const;
+    void refreshLocked();
+
+private:
+    std::mutex      mutex_;
+    std::string     secret_;         // 主密钥
+    int64_t         rotation_;       // 轮换周期（秒）
+    int64_t         acceptedEpochs_; // 可用于解密的 epoch 个数（含当前）
+    std::deque<Key> keys_;           // 可用的密钥，最新的在前
+};
+
+} // namespace ssl
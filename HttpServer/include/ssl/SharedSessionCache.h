@@ -0,0 +1,47 @@
+#pragma once
+#include <muduo/base/noncopyable.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ssl
+{
+
+// 跨进程共享的 TLS 会话缓存（用于 TLS 1.2 会话 ID 复用和关闭票据时的 TLS 1.3 有状态复用）
+// 数据放在 MAP_SHARED 映射的文件中（建议位于 /dev/shm），打开同一文件的进程共享缓存。
+// 按会话 ID 哈希直接映射到槽位，冲突时覆盖旧会话；每个槽位一把进程间共享的健壮互斥锁，
+// 拿不到锁时直接视为未命中，持锁进程崩溃后锁由下一个加锁者接手，不会永久占住槽位
+class SharedSessionCache : muduo::noncopyable
+{
+public:
+    static const size_t kMaxSessionIdLength = 32;
+    static const size_t kMaxSessionLength = 1024; // 单个序列化会话的最大长度
+
+    SharedSessionCache(const std::string& path, size_t slots);
+    ~SharedSessionCache();
+
+    bool valid() const { return slots_ != nullptr; }
+
+    // 保存序列化后的会话，expire 为过期时间（秒级时间戳）
+    bool store(const unsigned char* id, size_t idLen,
+               const unsigned char* data, size_t dataLen, int64_t expire);
+
+    // 查找未过期的会话，命中时把序列化数据写入 data
+    bool lookup(const unsigned char* id, size_t idLen, std::string* data);
+
+    void remove(const unsigned char* id, size_t idLen);
+
+private:
+    struct Header;
+    struct Slot;
+
+    Slot* slotFor(const unsigned char* id, size_t idLen) const;
+
+private:
+    void*  base_;      // 映射的起始地址
+    size_t mapLength_; // 映射长度
+    Slot*  slots_;     // 槽位数组
+    size_t slotCount_; // 槽位个数
+};
+
+} // namespace ssl
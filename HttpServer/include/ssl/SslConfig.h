@@ -6,6 +6,15 @@
 namespace ssl 
 {
 
+// 按 SNI 主机名选择的证书
+struct CertificateEntry
+{
+    std::string serverName; // 小写主机名，可为 "*.example.com" 形式的通配符（只匹配一级子域名）
+    std::string certFile;
+    std::string keyFile;
+    std::string chainFile;
+};
+
 class SslConfig 
 {
 public:
@@ -16,6 +25,15 @@ public:
     void setCertificateFile(const std::string& certFile) { certFile_ = certFile; }
     void setPrivateKeyFile(const std::string& keyFile) { keyFile_ = keyFile; }
     void setCertificateChainFile(const std::string& chainFile) { chainFile_ = chainFile; }
+
+    // SNI 多证书：客户端请求的主机名匹配 serverName 时使用该证书，都不匹配时使用上面的默认证书
+    void addCertificate(const std::string& serverName, const std::string& certFile,
+                        const std::string& keyFile, const std::string& chainFile = "")
+    {
+        certificates_.push_back({serverName, certFile, keyFile, chainFile});
+    }
+    // 证书文件检查周期（秒）：文件修改后自动重新加载证书，0 表示不检查
+    void setCertificateReloadInterval(int seconds) { certReloadInterval_ = seconds; }
     
     // 协议版本和加密套件配置
     void setProtocolVersion(SSLVersion version) { version_ = version; }
@@ -29,27 +47,60 @@ public:
     void setSessionTimeout(int seconds) { sessionTimeout_ = seconds; }
     void setSessionCacheSize(long size) { sessionCacheSize_ = size; }
 
+    // 会话票据配置：无状态票据的密钥按周期轮换
+    // 票据主密钥文件（至少32字节）供多个进程共享，为空时每个进程随机生成
+    void setSessionTickets(bool enable) { sessionTickets_ = enable; }
+    void setTicketKeyRotation(int seconds) { ticketKeyRotation_ = seconds; }
+    void setTicketKeyFile(const std::string& keyFile) { ticketKeyFile_ = keyFile; }
+
+    // 跨进程共享的会话缓存文件（如 /dev/shm/httpserver-ssl），为空时只使用进程内缓存
+    void setSharedSessionCache(const std::string& path, size_t slots = 4096)
+    {
+        sharedCachePath_ = path;
+        sharedCacheSlots_ = slots;
+    }
+
+    // 握手线程数：大于 0 时握手步骤（含私钥签名）交给独立的线程池执行，
+    // 完成后回到连接所属的 IO 线程继续，避免完整握手阻塞 EventLoop；0 表示在 IO 线程内握手
+    void setHandshakeThreads(int threads) { handshakeThreads_ = threads; }
+
     // Getters
     const std::string& getCertificateFile() const { return certFile_; }
     const std::string& getPrivateKeyFile() const { return keyFile_; }
     const std::string& getCertificateChainFile() const { return chainFile_; }
+    const std::vector<CertificateEntry>& getCertificates() const { return certificates_; }
+    int getCertificateReloadInterval() const { return certReloadInterval_; }
     SSLVersion getProtocolVersion() const { return version_; }
     const std::string& getCipherList() const { return cipherList_; }
     bool getVerifyClient() const { return verifyClient_; }
     int getVerifyDepth() const { return verifyDepth_; }
     int getSessionTimeout() const { return sessionTimeout_; }
     long getSessionCacheSize() const { return sessionCacheSize_; }
+    bool getSessionTickets() const { return sessionTickets_; }
+    int getTicketKeyRotation() const { return ticketKeyRotation_; }
+    const std::string& getTicketKeyFile() const { return ticketKeyFile_; }
+    const std::string& getSharedCachePath() const { return sharedCachePath_; }
+    size_t getSharedCacheSlots() const { return sharedCacheSlots_; }
+    int getHandshakeThreads() const { return handshakeThreads_; }
 
 private:
     std::string certFile_; // 证书文件
     std::string keyFile_; // 私钥文件
     std::string chainFile_; // 证书链文件
+    std::vector<CertificateEntry> certificates_; // 按 SNI 选择的证书
+    int         certReloadInterval_; // 证书文件检查周期（秒）
     SSLVersion  version_; // 协议版本
     std::string cipherList_; // 加密套件
     bool        verifyClient_; // 是否验证客户端
     int         verifyDepth_; // 验证深度
     int         sessionTimeout_; // 会话超时时间
     long        sessionCacheSize_; // 会话缓存大小
+    bool        sessionTickets_; // 是否签发会话票据
+    int         ticketKeyRotation_; // 票据密钥轮换周期（秒）
+    std::string ticketKeyFile_; // 票据主密钥文件
+    std::string sharedCachePath_; // 共享会话缓存文件
+    size_t      sharedCacheSlots_; // 共享会话缓存槽位数
+    int         handshakeThreads_; // 握手线程数
 };
 
 } // namespace ssl
\ No newline at end of file
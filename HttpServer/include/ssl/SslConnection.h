@@ -5,6 +5,7 @@
 #include <muduo/base/noncopyable.h>
 #include <openssl/ssl.h>
 #include <memory>
+#include <string>
 
 namespace ssl 
 {
@@ -14,7 +15,8 @@ using MessageCallback = std::function<void(const std::shared_ptr<muduo::net::Tcp
                                          muduo::net::Buffer*,
                                          muduo::Timestamp)>;
 
-class SslConnection : muduo::noncopyable 
+class SslConnection : muduo::noncopyable,
+                      public std::enable_shared_from_this<SslConnection>
 {
 public:
     using TcpConnectionPtr = std::shared_ptr<muduo::net::TcpConnection>;
@@ -24,11 +26,19 @@ public:
     ~SslConnection();
 
     void startHandshake();
+    // 加密 data 并发送，需在连接所属的 IO 线程调用
     void send(const void* data, size_t len);
+    // 分段发送：各段明文拼成满记录（16KB）再加密，整记录直接从原内存加密，
+    // 小段不会各自成为一个 TLS 记录；flush() 加密剩余部分并把本批密文一次交给连接
+    void write(const void* data, size_t len);
+    void flush();
+    // 消费 buf 中的密文：推进握手，并把所有完整的 TLS 记录解密到 decryptedBuffer_
+    // 不完整的记录留在 buf 中等待后续数据；有解密数据时调用消息回调
+    // 启用握手线程池时握手步骤异步执行，期间到达的数据留在 buf 中，握手完成后由 IO 线程补读
     void onRead(const TcpConnectionPtr& conn, BufferPtr buf, muduo::Timestamp time);
     bool isHandshakeCompleted() const { return state_ == SSLState::ESTABLISHED; }
     muduo::net::Buffer* getDecryptedBuffer() { return &decryptedBuffer_; }
-    // SSL BIO 操作回调
+    // SSL BIO 操作回调，密文直接在 muduo 的输入/输出缓冲区与 SSL 之间流动
     static int bioWrite(BIO* bio, const char* data, int len);
     static int bioRead(BIO* bio, char* data, int len);
     static long bioCtrl(BIO* bio, int cmd, long num, void* ptr);
@@ -36,8 +46,13 @@ public:
     void setMessageCallback(const MessageCallback& cb) { messageCallback_ = cb; }
 private:
     void handleHandshake();
-    void onEncrypted(const char* data, size_t len);
-    void onDecrypted(const char* data, size_t len);
+    void offloadHandshake(BufferPtr buf);
+    void onHandshakeOffloaded(int ret, int err, unsigned long errCode);
+    void finishHandshakeStep(int ret, int err, unsigned long errCode);
+    void deliverDecrypted(muduo::Timestamp time);
+    void readDecrypted();
+    bool encrypt(const char* data, size_t len);
+    void flushEncrypted();
     SSLError getLastError(int ret);
     void handleError(SSLError error);
 
@@ -46,12 +61,15 @@ private:
     SslContext*         ctx_; // SSL 上下文
     TcpConnectionPtr    conn_; // TCP 连接
     SSLState            state_; // SSL 状态
-    BIO*                readBio_;   // 网络数据 -> SSL
-    BIO*                writeBio_;  // SSL -> 网络数据
-    muduo::net::Buffer  readBuffer_; // 读缓冲区
-    muduo::net::Buffer  writeBuffer_; // 写缓冲区
+    BIO*                bio_;       // 网络数据 <-> SSL，读写共用
+    BufferPtr           input_;     // 当前正在消费的密文（TcpConnection 的输入缓冲区），仅在 onRead 期间有效
+    muduo::net::Buffer  writeBuffer_; // 待发送的密文
+    muduo::net::Buffer  pendingPlain_; // write() 留下的不足一个记录的明文
     muduo::net::Buffer  decryptedBuffer_; // 解密后的数据
     MessageCallback     messageCallback_; // 消息回调
+    muduo::net::Buffer  handshakeInput_; // 交给握手线程的密文，握手步骤执行期间归工作线程所有
+    bool                handshakeInFlight_; // 是否有握手步骤正在握手线程池中执行
+    muduo::Timestamp    handshakeStart_; // 收到第一段握手数据的时间
 };
 
 } // namespace ssl
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
 #include "SslConfig.h"
+#include "SessionTicketKeys.h"
+#include "SharedSessionCache.h"
 #include <openssl/ssl.h>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <muduo/base/noncopyable.h>
+#include <muduo/base/ThreadPool.h>
 
 namespace ssl 
 {
@@ -16,15 +22,94 @@ public:
     bool initialize();
     SSL_CTX* getNativeHandle() { return ctx_; }
 
+    // 重新加载全部证书，全部加载成功后原子地替换；进行中的握手继续使用旧证书，加载失败时保留旧证书
+    // 可在任意线程调用
+    bool reloadCertificates();
+    // 证书文件的修改时间或大小有变化时重新加载，返回是否替换了证书
+    bool reloadCertificatesIfChanged();
+
+    // 会话复用统计
+    struct SessionStats
+    {
+        uint64_t fullHandshakes;    // 完整握手次数
+        uint64_t resumedHandshakes; // 会话复用握手次数
+        uint64_t ticketsIssued;     // 签发的票据数
+        uint64_t ticketsAccepted;   // 用当前密钥解密成功的票据数
+        uint64_t ticketsRenewed;    // 用旧密钥解密成功并重新签发的票据数
+        uint64_t ticketsRejected;   // 密钥已淘汰或未知的票据数
+        uint64_t cacheHits;         // 共享会话缓存命中次数
+        uint64_t cacheMisses;       // 共享会话缓存未命中次数
+        uint64_t cacheStores;       // 写入共享会话缓存的会话数
+    };
+    SessionStats getSessionStats() const;
+
+    // 握手耗时与握手线程池统计
+    struct HandshakeStats
+    {
+        uint64_t handshakes;       // 完成的握手数
+        uint64_t totalLatencyUs;   // 握手总耗时（收到第一段握手数据到握手完成）
+        uint64_t maxLatencyUs;     // 最长的一次握手耗时
+        uint64_t offloaded;        // 交给握手线程池执行的握手步骤数
+        uint64_t totalQueueWaitUs; // 握手步骤在线程池队列中的总等待时间
+        int64_t  queueDepth;       // 当前排队等待的握手步骤数
+        int64_t  maxQueueDepth;    // 排队数峰值
+    };
+    HandshakeStats getHandshakeStats() const;
+
+    // 是否把握手步骤交给握手线程池执行
+    bool asyncHandshake() const { return handshakePool_ != nullptr; }
+    // 在握手线程池中执行 task，由 SslConnection 调用
+    void runHandshakeTask(std::function<void()> task);
+
+    // 握手完成时由 SslConnection 在 IO 线程调用，latencyUs 为握手耗时
+    void onHandshakeCompleted(bool resumed, int64_t latencyUs);
+
 private:
-    bool loadCertificates();
+    struct CertificateSet;
+    std::shared_ptr<const CertificateSet> loadCertificates();
+    SSL_CTX* createCertificateContext(const std::string& certFile, const std::string& keyFile,
+                                      const std::string& chainFile);
     bool setupProtocol();
-    void setupSessionCache();
+    bool setupSessionCache();
     static void handleSslError(const char* msg);
 
+    static int serverNameCallback(SSL* ssl, int* alert, void* arg);
+    static int ticketKeyCallback(SSL* ssl, unsigned char* keyName, unsigned char* iv,
+                                 EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc);
+    static int newSessionCallback(SSL* ssl, SSL_SESSION* session);
+    static SSL_SESSION* getSessionCallback(SSL* ssl, const unsigned char* id, int len, int* copy);
+    static void removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session);
+
 private:
-    SSL_CTX*  ctx_; // SSL上下文
-    SslConfig config_; // SSL配置
+    struct Counters
+    {
+        std::atomic<uint64_t> fullHandshakes{0};
+        std::atomic<uint64_t> resumedHandshakes{0};
+        std::atomic<uint64_t> ticketsIssued{0};
+        std::atomic<uint64_t> ticketsAccepted{0};
+        std::atomic<uint64_t> ticketsRenewed{0};
+        std::atomic<uint64_t> ticketsRejected{0};
+        std::atomic<uint64_t> cacheHits{0};
+        std::atomic<uint64_t> cacheMisses{0};
+        std::atomic<uint64_t> cacheStores{0};
+        std::atomic<uint64_t> handshakes{0};
+        std::atomic<uint64_t> totalLatencyUs{0};
+        std::atomic<uint64_t> maxLatencyUs{0};
+        std::atomic<uint64_t> offloaded{0};
+        std::atomic<uint64_t> totalQueueWaitUs{0};
+        std::atomic<int64_t>  queueDepth{0};
+        std::atomic<int64_t>  maxQueueDepth{0};
+    };
+
+    SSL_CTX*                            ctx_; // SSL上下文
+    SslConfig                           config_; // SSL配置
+    std::unique_ptr<SessionTicketKeys>  ticketKeys_; // 会话票据密钥环
+    std::unique_ptr<SharedSessionCache> sharedCache_; // 跨进程共享的会话缓存
+    Counters                            counters_; // 会话复用与握手统计
+    std::unique_ptr<muduo::ThreadPool>  handshakePool_; // 握手线程池，未启用时为空
+    // 当前证书，握手线程与重新加载线程通过 std::atomic_load/atomic_store 访问
+    std::shared_ptr<const CertificateSet> certificates_;
+    std::mutex                          reloadMutex_; // 串行化重新加载
 };
 
 } // namespace ssl
\ No newline at end of file
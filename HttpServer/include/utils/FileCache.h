@@ -0,0 +1,79 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <muduo/base/noncopyable.h>
+
+namespace http
+{
+
+// 只读映射的文件，缓存与在途响应共同持有，最后一个持有者释放时解除映射
+class MappedFile : muduo::noncopyable
+{
+public:
+    ~MappedFile();
+
+    const char* data() const
+    { return data_; }
+
+    size_t size() const
+    { return size_; }
+
+    time_t mtime() const
+    { return mtime_; }
+
+    // 打开的文件描述符，与映射同生命周期
+    int fd() const
+    { return fd_; }
+
+private:
+    friend class FileCache;
+    MappedFile() = default;
+
+    int         fd_ = -1;
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+    time_t      mtime_ = 0;
+    int64_t     mtimeNs_ = 0;
+    ino_t       inode_ = 0;
+};
+
+using MappedFilePtr = std::shared_ptr<const MappedFile>;
+
+// 静态文件缓存：打开的文件描述符、stat 结果和只读映射按路径缓存，
+// 同一路径在 revalidateInterval 内不再 stat，之后修改时间、大小或 inode 变化时重新打开
+// 映射期间就地截断文件会使读取触发 SIGBUS，更新文件应先写新文件再 rename 覆盖
+class FileCache : muduo::noncopyable
+{
+public:
+    explicit FileCache(std::chrono::milliseconds revalidateInterval = std::chrono::milliseconds(1000))
+        : revalidateInterval_(revalidateInterval)
+    {}
+
+    // 取得 path 对应的文件，不存在或不是普通文件时返回空；可在任意线程调用
+    MappedFilePtr get(const std::string& path);
+
+    // 丢弃所有缓存的文件
+    void clear();
+
+private:
+    struct Entry
+    {
+        MappedFilePtr                         file;
+        std::chrono::steady_clock::time_point checkedAt; // 上一次 stat 的时间
+    };
+
+    static MappedFilePtr open(const std::string& path);
+
+    std::chrono::milliseconds              revalidateInterval_;
+    std::mutex                             mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace http
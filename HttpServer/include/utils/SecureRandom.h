@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+namespace http
+{
+
+// 密码学安全的随机字节。每个线程从内核（getrandom）成块取随机数缓存在线程局部缓冲区中，
+// 之后的调用只从缓冲区拷贝，线程之间不加锁；fork 后子进程丢弃继承来的缓冲区
+void secureRandomBytes(void* out, size_t len);
+
+// 生成 len 字节随机数，以小写十六进制写入 out（长度至少 2 * len，不加结尾的 '\0'）
+void secureRandomHex(char* out, size_t len);
+
+} // namespace http
@@ -0,0 +1,49 @@
+#include "../../include/http/DateCache.h"
+
+#include <time.h>
+
+namespace http
+{
+
+namespace
+{
+
+struct CachedDate
+{
+    char   buf[48];
+    size_t len = 0;
+    time_t second = -1;
+    bool   timerInstalled = false;
+};
+
+thread_local CachedDate cachedDate;
+
+} // namespace
+
+void DateCache::install(muduo::net::EventLoop* loop)
+{
+    refresh();
+    cachedDate.timerInstalled = true;
+    loop->runEvery(1.0, &DateCache::refresh);
+}
+
+std::string_view DateCache::header()
+{
+    if (!cachedDate.timerInstalled && ::time(nullptr) != cachedDate.second)
+    {
+        refresh();
+    }
+    return std::string_view(cachedDate.buf, cachedDate.len);
+}
+
+void DateCache::refresh()
+{
+    time_t now = ::time(nullptr);
+    struct tm tm;
+    gmtime_r(&now, &tm);
+    cachedDate.len = strftime(cachedDate.buf, sizeof cachedDate.buf,
+                              "Date: %a, %d %b %Y %H:%M:%S GMT\r\n", &tm);
+    cachedDate.second = now;
+}
+
+} // namespace http
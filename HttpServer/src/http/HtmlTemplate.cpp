@@ -0,0 +1,130 @@
+#include "../../include/http/HtmlTemplate.h"
+
+namespace http
+{
+
+std::shared_ptr<HtmlTemplate> HtmlTemplate::compile(std::string text,
+                                                   const std::vector<std::string>& slotNames)
+{
+    std::shared_ptr<HtmlTemplate> tmpl(new HtmlTemplate(std::move(text)));
+    const std::string& source = tmpl->text_;
+    size_t pos = 0; // 当前静态片段的起点
+    size_t search = 0;
+    for (;;)
+    {
+        size_t open = source.find("{{", search);
+        size_t close = open == std::string::npos ? std::string::npos : source.find("}}", open + 2);
+        if (close == std::string::npos)
+        {
+            break;
+        }
+        std::string_view name(source.data() + open + 2, close - open - 2);
+        bool known = false;
+        for (const std::string& slotName : slotNames)
+        {
+            if (slotName == name)
+            {
+                known = true;
+                break;
+            }
+        }
+        if (!known)
+        {
+            // 不是插槽，保留在静态片段中
+            search = open + 2;
+            continue;
+        }
+        if (open > pos)
+        {
+            tmpl->pieces_.push_back({pos, open - pos, -1});
+        }
+        tmpl->pieces_.push_back({0, 0, tmpl->addSlot(name)});
+        pos = close + 2;
+        search = pos;
+    }
+    if (pos < source.size())
+    {
+        tmpl->pieces_.push_back({pos, source.size() - pos, -1});
+    }
+    return tmpl;
+}
+
+bool HtmlTemplate::addSlotBefore(std::string_view marker, const std::string& name)
+{
+    for (size_t i = 0; i < pieces_.size(); ++i)
+    {
+        Piece piece = pieces_[i];
+        if (piece.slot >= 0)
+        {
+            continue;
+        }
+        size_t found = std::string_view(text_.data() + piece.offset, piece.length).find(marker);
+        if (found == std::string_view::npos)
+        {
+            continue;
+        }
+        // 把静态片段在 marker 处一分为二，中间放入插槽
+        std::vector<Piece> split;
+        if (found > 0)
+        {
+            split.push_back({piece.offset, found, -1});
+        }
+        split.push_back({0, 0, addSlot(name)});
+        split.push_back({piece.offset + found, piece.length - found, -1});
+        pieces_.erase(pieces_.begin() + i);
+        pieces_.insert(pieces_.begin() + i, split.begin(), split.end());
+        return true;
+    }
+    return false;
+}
+
+int HtmlTemplate::slotIndex(std::string_view name) const
+{
+    for (size_t i = 0; i < slotNames_.size(); ++i)
+    {
+        if (slotNames_[i] == name)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int HtmlTemplate::addSlot(std::string_view name)
+{
+    int index = slotIndex(name);
+    if (index >= 0)
+    {
+        return index;
+    }
+    slotNames_.emplace_back(name);
+    return static_cast<int>(slotNames_.size() - 1);
+}
+
+void HtmlTemplate::render(std::vector<std::string> values, HttpResponse* resp) const
+{
+    values.resize(slotNames_.size());
+    // 动态字符串整体交给响应持有，静态片段由模板自身持有
+    auto dynamic = std::make_shared<const std::vector<std::string>>(std::move(values));
+    std::shared_ptr<const HtmlTemplate> self = shared_from_this();
+
+    resp->clearBody();
+    size_t length = 0;
+    for (const Piece& piece : pieces_)
+    {
+        if (piece.slot < 0)
+        {
+            resp->appendBodySegment(self, text_.data() + piece.offset, piece.length);
+            length += piece.length;
+        }
+        else
+        {
+            const std::string& value = (*dynamic)[piece.slot];
+            resp->appendBodySegment(dynamic, value.data(), value.size());
+            length += value.size();
+        }
+    }
+    resp->setContentLength(length);
+}
+
+} // namespace http
@@ -1,12 +1,24 @@
 #include "../../include/http/HttpContext.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
 using namespace muduo;
 using namespace muduo::net;
 
 namespace http
 {
 
+// 在 [begin, end) 中查找字符 c，找不到时返回 end；memchr 由 libc 向量化实现
+static inline const char *findChar(const char *begin, const char *end, char c)
+{
+    const void *p = memchr(begin, c, end - begin);
+    return p ? static_cast<const char *>(p) : end;
+}
+
 // 将报文解析出来将关键信息封装到HttpRequest对象里面去
+// 请求头接收完整后一次性拷入本连接的输入区，HttpRequest 中的字段只是指向输入区的 string_view
 bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
 {
     bool ok = true; // 解析每行请求格式是否正确
@@ -15,83 +27,49 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
     {
         if (state_ == kExpectRequestLine)
         {
-            const char *crlf = buf->findCRLF(); // 注意这个返回值边界可能有错
-            if (crlf)
+            // 一次扫描找出所有行尾和冒号，请求头不完整时下次从停下的位置继续
+            // 只扫描不超过上限的部分，已到达上限仍没有空行时请求头过长
+            size_t scanLen = std::min(buf->readableBytes(), maxHeaderSize_);
+            size_t headLen = HttpScanner::scanHead(buf->peek(), scanLen, &scanState_);
+            if (headLen == 0)
             {
-                ok = processRequestLine(buf->peek(), crlf);
-                if (ok)
+                if (scanLen == maxHeaderSize_)
                 {
-                    request_.setReceiveTime(receiveTime);
-                    buf->retrieveUntil(crlf + 2);
-                    state_ = kExpectHeaders;
-                }
-                else
-                {
-                    hasMore = false;
+                    ok = fail(HttpResponse::k431RequestHeaderFieldsTooLarge);
                 }
+                hasMore = false; // 请求头不完整，等待更多数据
+                continue;
             }
-            else
+
+            // 保留最后一个请求头的CRLF，丢弃结束请求头的空行
+            slab_->head.assign(buf->peek(), headLen - 2);
+            buf->retrieve(headLen);
+            request_.setSlab(slab_);
+
+            const char *base = slab_->head.data();
+            const auto &lines = scanState_.lines;
+            ok = !lines.empty() && processRequestLine(base + lines[0].begin, base + lines[0].end);
+            if (ok)
             {
-                hasMore = false;
+                request_.setReceiveTime(receiveTime);
+                ok = processHeaders(base);
             }
-        }
-        else if (state_ == kExpectHeaders)
-        {
-            const char *crlf = buf->findCRLF();
-            if (crlf)
+
+            if (ok)
             {
-                const char *colon = std::find(buf->peek(), crlf, ':');
-                if (colon < crlf)
-                {
-                    request_.addHeader(buf->peek(), colon, crlf);
-                }
-                else if (buf->peek() == crlf)
-                { 
-                    // 空行，结束Header
-                    // 根据请求方法和Content-Length判断是否需要继续读取body
-                    if (request_.method() == HttpRequest::kPost || 
-                        request_.method() == HttpRequest::kPut)
-                    {
-                        std::string contentLength = request_.getHeader("Content-Length");
-                        if (!contentLength.empty())
-                        {
-                            request_.setContentLength(std::stoi(contentLength));
-                            if (request_.contentLength() > 0)
-                            {
-                                state_ = kExpectBody;
-                            }
-                            else
-                            {
-                                state_ = kGotAll;
-                                hasMore = false;
-                            }
-                        }
-                        else
-                        {
-                            // POST/PUT 请求没有 Content-Length，是HTTP语法错误
-                            ok = false;
-                            hasMore = false;
-                        }
-                    }
-                    else
-                    {
-                        // GET/HEAD/DELETE 等方法直接完成（没有请求体）
-                        state_ = kGotAll; 
-                        hasMore = false;
-                    }
-                }
-                else
-                {
-                    ok = false; // Header行格式错误
-                    hasMore = false;
-                }
-                buf->retrieveUntil(crlf + 2); // 开始读指针指向下一行数据
+                state_ = kExpectHeaders;
             }
             else
             {
                 hasMore = false;
             }
         }
+        else if (state_ == kExpectHeaders)
+        {
+            // 请求头已解析完毕，按 Transfer-Encoding / Content-Length 确定请求体的边界
+            ok = processBodyFraming();
+            hasMore = ok && state_ != kGotAll;
+        }
         else if (state_ == kExpectBody)
         {
             // 检查缓冲区中是否有足够的数据
@@ -101,9 +79,9 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
                 return true;
             }
 
-            // 只读取 Content-Length 指定的长度
-            std::string body(buf->peek(), buf->peek() + request_.contentLength());
-            request_.setBody(body);
+            // 只读取 Content-Length 指定的长度，拷入输入区后由请求直接引用
+            slab_->body.assign(buf->peek(), request_.contentLength());
+            request_.setBody(slab_->body.data(), slab_->body.data() + slab_->body.size());
 
             // 准确移动读指针
             buf->retrieve(request_.contentLength());
@@ -111,23 +89,218 @@ bool HttpContext::parseRequest(Buffer *buf, Timestamp receiveTime)
             state_ = kGotAll;
             hasMore = false;
         }
+        else if (state_ == kExpectChunkSize)
+        {
+            // chunk-size [; chunk-ext] CRLF
+            const char *crlf = buf->findCRLF();
+            if (!crlf || static_cast<size_t>(crlf - buf->peek()) > kMaxChunkLineLength)
+            {
+                if (crlf || buf->readableBytes() > kMaxChunkLineLength)
+                {
+                    ok = false; // 分块大小行过长
+                }
+                hasMore = false;
+                continue;
+            }
+
+            uint64_t size = 0;
+            auto [ptr, ec] = std::from_chars(buf->peek(), crlf, size, 16);
+            if (ec != std::errc() || ptr == buf->peek() ||
+                (ptr != crlf && *ptr != ';' && *ptr != ' ' && *ptr != '\t'))
+            {
+                ok = false; // 分块大小格式错误
+                hasMore = false;
+                continue;
+            }
+            if (size > maxBodySize_ - slab_->body.size())
+            {
+                ok = fail(HttpResponse::k413PayloadTooLarge);
+                hasMore = false;
+                continue;
+            }
+            buf->retrieveUntil(crlf + 2);
+
+            if (size == 0)
+            {
+                state_ = kExpectChunkTrailers; // 结束块
+            }
+            else
+            {
+                chunkRemaining_ = size;
+                state_ = kExpectChunkData;
+            }
+        }
+        else if (state_ == kExpectChunkData)
+        {
+            // 已到达的分块数据直接解码进输入区，不必等整块到齐
+            size_t n = static_cast<size_t>(std::min<uint64_t>(buf->readableBytes(), chunkRemaining_));
+            if (n == 0)
+            {
+                hasMore = false;
+                continue;
+            }
+            slab_->body.append(buf->peek(), n);
+            buf->retrieve(n);
+            chunkRemaining_ -= n;
+            if (chunkRemaining_ == 0)
+            {
+                state_ = kExpectChunkCRLF;
+            }
+        }
+        else if (state_ == kExpectChunkCRLF)
+        {
+            if (buf->readableBytes() < 2)
+            {
+                hasMore = false;
+                continue;
+            }
+            if (buf->peek()[0] != '\r' || buf->peek()[1] != '\n')
+            {
+                ok = false; // 分块数据后缺少CRLF
+                hasMore = false;
+                continue;
+            }
+            buf->retrieve(2);
+            state_ = kExpectChunkSize;
+        }
+        else if (state_ == kExpectChunkTrailers)
+        {
+            // trailer 不使用，逐行丢弃直到空行
+            const char *crlf = buf->findCRLF();
+            if (!crlf || static_cast<size_t>(crlf - buf->peek()) > kMaxChunkLineLength)
+            {
+                if (crlf || buf->readableBytes() > kMaxChunkLineLength)
+                {
+                    ok = false; // trailer 行过长
+                }
+                hasMore = false;
+                continue;
+            }
+
+            bool lastLine = (crlf == buf->peek());
+            buf->retrieveUntil(crlf + 2);
+            if (lastLine)
+            {
+                request_.setBody(slab_->body.data(), slab_->body.data() + slab_->body.size());
+                request_.setContentLength(slab_->body.size());
+                state_ = kGotAll;
+                hasMore = false;
+            }
+        }
     }
     return ok; // ok为false代表报文语法解析错误
 }
 
+// 根据请求头确定请求体的边界，所有方法一视同仁，避免把请求体当作下一个请求解析（请求走私）
+// Transfer-Encoding 为逗号分隔的编码列表，可能分布在多行中；只支持单独的 chunked，
+// 其他编码返回 501。Transfer-Encoding 与 Content-Length 同时出现、多个 Content-Length 不一致时返回 400
+bool HttpContext::processBodyFraming()
+{
+    bool hasTransferEncoding = false;
+    int chunkedCount = 0;
+    std::string_view lastCoding;
+    bool otherCoding = false;
+    std::string_view contentLength;
+    bool hasContentLength = false;
+    for (const auto &header : request_.headers())
+    {
+        if (equalsIgnoreCase(header.first, "Transfer-Encoding"))
+        {
+            hasTransferEncoding = true;
+            std::string_view value = header.second;
+            while (!value.empty())
+            {
+                size_t comma = value.find(',');
+                std::string_view coding = value.substr(0, comma);
+                value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+                while (!coding.empty() && (coding.front() == ' ' || coding.front() == '\t'))
+                {
+                    coding.remove_prefix(1);
+                }
+                while (!coding.empty() && (coding.back() == ' ' || coding.back() == '\t'))
+                {
+                    coding.remove_suffix(1);
+                }
+                if (coding.empty())
+                {
+                    continue; // 列表中允许空元素
+                }
+                if (equalsIgnoreCase(coding, "chunked"))
+                {
+                    ++chunkedCount;
+                }
+                else
+                {
+                    otherCoding = true;
+                }
+                lastCoding = coding;
+            }
+        }
+        else if (equalsIgnoreCase(header.first, "Content-Length"))
+        {
+            if (hasContentLength && header.second != contentLength)
+            {
+                return fail(HttpResponse::k400BadRequest);
+            }
+            hasContentLength = true;
+            contentLength = header.second;
+        }
+    }
+
+    if (hasTransferEncoding)
+    {
+        if (hasContentLength || lastCoding.empty() || chunkedCount > 1)
+        {
+            return fail(HttpResponse::k400BadRequest);
+        }
+        if (!equalsIgnoreCase(lastCoding, "chunked") || otherCoding)
+        {
+            return fail(HttpResponse::k501NotImplemented);
+        }
+        // 分块编码的请求体边到达边解码
+        state_ = kExpectChunkSize;
+        return true;
+    }
+
+    if (!hasContentLength)
+    {
+        // POST/PUT 请求没有合法的 Content-Length，是HTTP语法错误；其他方法没有请求体
+        if (request_.method() == HttpRequest::kPost || request_.method() == HttpRequest::kPut)
+        {
+            return fail(HttpResponse::k400BadRequest);
+        }
+        state_ = kGotAll;
+        return true;
+    }
+
+    uint64_t length = 0;
+    auto [ptr, ec] = std::from_chars(contentLength.data(), contentLength.data() + contentLength.size(), length);
+    if (contentLength.empty() || ec != std::errc() || ptr != contentLength.data() + contentLength.size())
+    {
+        return fail(HttpResponse::k400BadRequest);
+    }
+    if (length > maxBodySize_)
+    {
+        return fail(HttpResponse::k413PayloadTooLarge);
+    }
+    request_.setContentLength(length);
+    state_ = length > 0 ? kExpectBody : kGotAll;
+    return true;
+}
+
 // 解析请求行
 bool HttpContext::processRequestLine(const char *begin, const char *end)
 {
     bool succeed = false;
     const char *start = begin;
-    const char *space = std::find(start, end, ' ');
+    const char *space = findChar(start, end, ' ');
     if (space != end && request_.setMethod(start, space))
     {
         start = space + 1;
-        space = std::find(start, end, ' ');
+        space = findChar(start, end, ' ');
         if (space != end)
         {
-            const char *argumentStart = std::find(start, space, '?');
+            const char *argumentStart = findChar(start, space, '?');
             if (argumentStart != space) // 请求带参数
             {
                 request_.setPath(start, argumentStart); // 注意这些返回值边界
@@ -160,4 +333,19 @@ bool HttpContext::processRequestLine(const char *begin, const char *end)
     return succeed;
 }
 
+// 解析请求头，各行位置由扫描器给出，base 为请求头在输入区中的起始地址
+bool HttpContext::processHeaders(const char *base)
+{
+    const auto &lines = scanState_.lines;
+    for (size_t i = 1; i < lines.size(); ++i)
+    {
+        if (lines[i].colon == HttpScanner::kNoColon)
+        {
+            return false; // Header行格式错误
+        }
+        request_.addHeader(base + lines[i].begin, base + lines[i].colon, base + lines[i].end);
+    }
+    return true;
+}
+
 } // namespace http
\ No newline at end of file
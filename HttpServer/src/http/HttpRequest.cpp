@@ -1,5 +1,8 @@
 #include "../../include/http/HttpRequest.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace http
 {
 
@@ -11,7 +14,7 @@ void HttpRequest::setReceiveTime(muduo::Timestamp t)
 bool HttpRequest::setMethod(const char *start, const char *end)
 {
     assert(method_ == kInvalid);
-    std::string m(start, end); // [start, end)
+    std::string_view m(start, end - start); // [start, end)
     if (m == "GET")
     {
         method_ = kGet;
@@ -42,7 +45,14 @@ bool HttpRequest::setMethod(const char *start, const char *end)
 
 void HttpRequest::setPath(const char *start, const char *end)
 {
-    path_.assign(start, end);
+    path_ = std::string_view(start, end - start);
+    pathOwned_ = false;
+}
+
+void HttpRequest::setPath(const std::string &path)
+{
+    ownedPath_ = path;
+    pathOwned_ = true;
 }
 
 void HttpRequest::setPathParameters(const std::string &key, const std::string &value)
@@ -60,75 +70,118 @@ std::string HttpRequest::getPathParameters(const std::string &key) const
     return "";
 }
 
-std::string HttpRequest::getQueryParameters(const std::string &key) const
+std::string_view HttpRequest::getQueryParameters(std::string_view key) const
 {
-    auto it = queryParameters_.find(key);
-    if (it != queryParameters_.end())
+    for (const auto &[k, v] : queryParameters_)
     {
-        return it->second;
+        if (k == key)
+        {
+            return v;
+        }
     }
-    return "";
+    return std::string_view();
 }
 
-// 这是从问号后面分割参数
+// 这是从问号后面分割参数，键值均直接引用输入区中的数据
 void HttpRequest::setQueryParameters(const char *start, const char *end)
 {
-    std::string argumentStr(start, end);
-    std::string::size_type pos = 0;
-    std::string::size_type prev = 0;
+    std::string_view argumentStr(start, end - start);
+    std::string_view::size_type prev = 0;
 
     // 按 & 分割多个参数
-    while ((pos = argumentStr.find('&', prev)) != std::string::npos)
+    while (prev <= argumentStr.size())
     {
-        std::string pair = argumentStr.substr(prev, pos - prev);
-        std::string::size_type equalPos = pair.find('=');
+        std::string_view::size_type pos = argumentStr.find('&', prev);
+        if (pos == std::string_view::npos)
+        {
+            pos = argumentStr.size(); // 处理最后一个参数
+        }
 
-        if (equalPos != std::string::npos)
+        std::string_view pair = argumentStr.substr(prev, pos - prev);
+        std::string_view::size_type equalPos = pair.find('=');
+        if (equalPos != std::string_view::npos)
         {
-            std::string key = pair.substr(0, equalPos);
-            std::string value = pair.substr(equalPos + 1);
-            queryParameters_[key] = value;
+            queryParameters_.emplace_back(pair.substr(0, equalPos), pair.substr(equalPos + 1));
         }
 
         prev = pos + 1;
     }
-
-    // 处理最后一个参数
-    std::string lastPair = argumentStr.substr(prev);
-    std::string::size_type equalPos = lastPair.find('=');
-    if (equalPos != std::string::npos)
-    {
-        std::string key = lastPair.substr(0, equalPos);
-        std::string value = lastPair.substr(equalPos + 1);
-        queryParameters_[key] = value;
-    }
 }
 
 void HttpRequest::addHeader(const char *start, const char *colon, const char *end)
 {
-    std::string key(start, colon);
+    std::string_view key(start, colon - start);
     ++colon;
     while (colon < end && isspace(*colon))
     {
         ++colon;
     }
-    std::string value(colon, end);
-    while (!value.empty() && isspace(value[value.size() - 1])) // 消除尾部空格
+    while (end > colon && isspace(*(end - 1))) // 消除尾部空格
+    {
+        --end;
+    }
+    std::string_view value(colon, end - colon);
+    headers_.emplace_back(key, value);
+
+    KnownHeader known = knownHeaderOf(key);
+    if (known != kKnownHeaderCount && knownHeaders_[known].data() == nullptr)
+    {
+        knownHeaders_[known] = value;
+    }
+}
+
+HttpRequest::KnownHeader HttpRequest::knownHeaderOf(std::string_view field)
+{
+    // 先按长度区分，每种长度最多比较一次
+    KnownHeader candidate;
+    std::string_view name;
+    switch (field.size())
     {
-        value.resize(value.size() - 1);
+        case 4:  candidate = kHost;           name = "Host";            break;
+        case 6:  candidate = kCookie;         name = "Cookie";          break;
+        case 10: candidate = kConnection;     name = "Connection";      break;
+        case 12: candidate = kContentType;    name = "Content-Type";    break;
+        case 14: candidate = kContentLength;  name = "Content-Length";  break;
+        case 15: candidate = kAcceptEncoding; name = "Accept-Encoding"; break;
+        default: return kKnownHeaderCount;
     }
-    headers_[key] = value;
+    return equalsIgnoreCase(field, name) ? candidate : kKnownHeaderCount;
 }
 
-std::string HttpRequest::getHeader(const std::string &field) const
+std::string_view HttpRequest::getHeader(std::string_view field) const
 {
-    std::string result;
-    auto it = headers_.find(field);
-    if (it != headers_.end())
+    KnownHeader known = knownHeaderOf(field);
+    if (known != kKnownHeaderCount)
     {
-        result = it->second;
+        return knownHeaders_[known];
     }
-    return result;
+    for (const auto &[key, value] : headers_)
+    {
+        if (equalsIgnoreCase(key, field))
+        {
+            return value;
+        }
+    }
+    return std::string_view();
+}
+
+void HttpRequest::reset()
+{
+    method_ = kInvalid;
+    version_ = "Unknown";
+    path_ = std::string_view();
+    pathParameters_.clear();
+    queryParameters_.clear();
+    receiveTime_ = muduo::Timestamp();
+    headers_.clear();
+    std::fill(std::begin(knownHeaders_), std::end(knownHeaders_), std::string_view());
+    body_ = std::string_view();
+    contentLength_ = 0;
+    slab_.reset();
+    ownedPath_.clear();
+    ownedBody_.clear();
+    pathOwned_ = false;
+    bodyOwned_ = false;
 }
 
 void HttpRequest::swap(HttpRequest &that)
@@ -139,7 +192,15 @@ void HttpRequest::swap(HttpRequest &that)
     std::swap(queryParameters_, that.queryParameters_);
     std::swap(version_, that.version_);
     std::swap(headers_, that.headers_);
+    std::swap(knownHeaders_, that.knownHeaders_);
     std::swap(receiveTime_, that.receiveTime_);
+    std::swap(body_, that.body_);
+    std::swap(contentLength_, that.contentLength_);
+    std::swap(slab_, that.slab_);
+    std::swap(ownedPath_, that.ownedPath_);
+    std::swap(ownedBody_, that.ownedBody_);
+    std::swap(pathOwned_, that.pathOwned_);
+    std::swap(bodyOwned_, that.bodyOwned_);
 }
 
 } // namespace http
\ No newline at end of file
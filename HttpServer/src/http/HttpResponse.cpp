@@ -1,18 +1,85 @@
 #include "../../include/http/HttpResponse.h"
+#include "../../include/http/ResponseWriter.h"
+#include "../../include/http/DateCache.h"
 
 namespace http
 {
 
+namespace
+{
+
+// 预先格式化的状态行，按状态码和协议版本查表，不再逐个响应格式化
+struct StatusLine
+{
+    HttpResponse::HttpStatusCode code;
+    std::string_view             reason;
+    std::string_view             http10;
+    std::string_view             http11;
+};
+
+#define HTTP_STATUS_LINE(code, number, reason) \
+    { HttpResponse::code, reason, "HTTP/1.0 " #number " " reason "\r\n", "HTTP/1.1 " #number " " reason "\r\n" }
+
+constexpr StatusLine kStatusLines[] = {
+    HTTP_STATUS_LINE(k200Ok, 200, "OK"),
+    HTTP_STATUS_LINE(k204NoContent, 204, "No Content"),
+    HTTP_STATUS_LINE(k301MovedPermanently, 301, "Moved Permanently"),
+    HTTP_STATUS_LINE(k304NotModified, 304, "Not Modified"),
+    HTTP_STATUS_LINE(k400BadRequest, 400, "Bad Request"),
+    HTTP_STATUS_LINE(k401Unauthorized, 401, "Unauthorized"),
+    HTTP_STATUS_LINE(k403Forbidden, 403, "Forbidden"),
+    HTTP_STATUS_LINE(k404NotFound, 404, "Not Found"),
+    HTTP_STATUS_LINE(k405MethodNotAllowed, 405, "Method Not Allowed"),
+    HTTP_STATUS_LINE(k409Conflict, 409, "Conflict"),
+    HTTP_STATUS_LINE(k413PayloadTooLarge, 413, "Payload Too Large"),
+    HTTP_STATUS_LINE(k431RequestHeaderFieldsTooLarge, 431, "Request Header Fields Too Large"),
+    HTTP_STATUS_LINE(k500InternalServerError, 500, "Internal Server Error"),
+    HTTP_STATUS_LINE(k501NotImplemented, 501, "Not Implemented"),
+};
+
+#undef HTTP_STATUS_LINE
+
+const StatusLine* findStatusLine(HttpResponse::HttpStatusCode code)
+{
+    for (const StatusLine& line : kStatusLines)
+    {
+        if (line.code == code)
+        {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
 {
-    // HttpResponse封装的信息格式化输出
-    char buf[32]; 
-    // 为什么不把状态信息放入格式化字符串中，因为状态信息有长有短，不方便定义一个固定大小的内存存储
-    snprintf(buf, sizeof buf, "%s %d ", httpVersion_.c_str(), statusCode_);
-    
-    outputBuf->append(buf);
-    outputBuf->append(statusMessage_);
-    outputBuf->append("\r\n");
+    appendHeadersToBuffer(outputBuf);
+    outputBuf->append(body_);
+}
+
+void HttpResponse::appendHeadersToBuffer(muduo::net::Buffer* outputBuf) const
+{
+    // 标准的状态行直接取预先格式化好的字符串
+    const StatusLine* line = findStatusLine(statusCode_);
+    bool http10 = (httpVersion_ == "HTTP/1.0");
+    if (line && (statusMessage_.empty() || statusMessage_ == line->reason)
+        && (http10 || httpVersion_.empty() || httpVersion_ == "HTTP/1.1"))
+    {
+        std::string_view text = http10 ? line->http10 : line->http11;
+        outputBuf->append(text.data(), text.size());
+    }
+    else
+    {
+        // 非标准的状态码或原因短语，未设置版本时按 HTTP/1.1
+        char buf[16];
+        snprintf(buf, sizeof buf, " %d ", statusCode_);
+        outputBuf->append(httpVersion_.empty() ? "HTTP/1.1" : httpVersion_);
+        outputBuf->append(buf);
+        outputBuf->append(statusMessage_);
+        outputBuf->append("\r\n");
+    }
 
     if (closeConnection_) // 思考一下这些地方是不是可以直接移入近headers_中
     {
@@ -20,11 +87,16 @@ void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
     }
     else
     {
-        //snprintf(buf, sizeof buf, "Content-Length: %zd\r\n", body_.size());
-        //outputBuf->append(buf);
         outputBuf->append("Connection: Keep-Alive\r\n");
     }
 
+    // 处理器没有自行设置 Date 时使用本线程每秒刷新一次的缓存
+    if (!findHeader("Date"))
+    {
+        std::string_view date = DateCache::header();
+        outputBuf->append(date.data(), date.size());
+    }
+
     for (const auto& header : headers_)
     { // 为什么这里不用格式化字符串？因为key和value的长度不定
         outputBuf->append(header.first);
@@ -33,8 +105,102 @@ void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
         outputBuf->append("\r\n");
     }
     outputBuf->append("\r\n");
-    
-    outputBuf->append(body_);
+}
+
+void HttpResponse::addHeader(const std::string& key, const std::string& value)
+{
+    // 同名响应头覆盖原值
+    for (auto& header : headers_)
+    {
+        if (header.first == key)
+        {
+            header.second = value;
+            return;
+        }
+    }
+    headers_.emplace_back(key, value);
+}
+
+const std::string* HttpResponse::findHeader(std::string_view key) const
+{
+    for (const auto& header : headers_)
+    {
+        if (header.first == key)
+        {
+            return &header.second;
+        }
+    }
+    return nullptr;
+}
+
+void HttpResponse::shareBody()
+{
+    if (body_.empty())
+    {
+        return;
+    }
+    // 移动而非拷贝，字符串的内存转交给共享段持有
+    auto owner = std::make_shared<const std::string>(std::move(body_));
+    body_.clear();
+    bodySegments_.insert(bodySegments_.begin(), SharedBody{owner, owner->data(), owner->size()});
+}
+
+void HttpResponse::ChunkWriter::write(const char* data, size_t len)
+{
+    if (len == 0)
+    {
+        return; // 长度为0的块代表结束，不能在这里写出
+    }
+
+    if (chunked_)
+    {
+        char buf[32];
+        snprintf(buf, sizeof buf, "%zx\r\n", len);
+        output_->append(buf);
+        output_->append(data, len);
+        output_->append("\r\n");
+    }
+    else
+    {
+        output_->append(data, len);
+    }
+}
+
+void HttpResponse::ChunkWriter::finish()
+{
+    if (chunked_)
+    {
+        output_->append("0\r\n\r\n");
+    }
+}
+
+std::shared_ptr<ResponseWriter> HttpResponse::defer()
+{
+    if (!deferHook_ || deferred_)
+    {
+        return nullptr;
+    }
+    DeferHook hook = std::move(deferHook_);
+    deferHook_ = nullptr;
+    std::vector<DeferListener> listeners = std::move(deferListeners_);
+    deferListeners_.clear();
+    auto writer = hook(this);
+    deferred_ = true;
+    for (const auto& listener : listeners)
+    {
+        listener(writer);
+    }
+    return writer;
+}
+
+void HttpResponse::notifyWritten()
+{
+    std::vector<WrittenListener> listeners = std::move(writtenListeners_);
+    writtenListeners_.clear();
+    for (const auto& listener : listeners)
+    {
+        listener();
+    }
 }
 
 void HttpResponse::setStatusLine(const std::string& version,
@@ -0,0 +1,159 @@
+#include "../../include/http/HttpScanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCANNER_X86 1
+#endif
+
+namespace http
+{
+
+namespace
+{
+
+using ScanFn = size_t (*)(const char*, size_t, HttpScanner::State*);
+
+// 处理一个分隔符（'\n' 或 ':'），请求头结束时返回 true
+inline bool onDelimiter(const char* data, uint32_t pos, HttpScanner::State* st)
+{
+    if (data[pos] == ':')
+    {
+        if (st->colon == HttpScanner::kNoColon)
+        {
+            st->colon = pos;
+        }
+        return false;
+    }
+
+    // 只有 CRLF 才算行尾，单独的 '\n' 忽略
+    if (pos == 0 || data[pos - 1] != '\r')
+    {
+        return false;
+    }
+
+    uint32_t lineEnd = pos - 1;
+    if (lineEnd == st->lineBegin)
+    {
+        return true; // 空行，请求头结束
+    }
+    st->lines.push_back({st->lineBegin, st->colon, lineEnd});
+    st->lineBegin = pos + 1;
+    st->colon = HttpScanner::kNoColon;
+    return false;
+}
+
+// 逐个处理掩码中置位的分隔符，mask 的第 i 位对应 data[base + i]
+inline bool onMask(const char* data, uint32_t base, uint32_t mask,
+                   HttpScanner::State* st, size_t* headLen)
+{
+    while (mask)
+    {
+        uint32_t pos = base + __builtin_ctz(mask);
+        if (onDelimiter(data, pos, st))
+        {
+            *headLen = pos + 1;
+            return true;
+        }
+        mask &= mask - 1;
+    }
+    return false;
+}
+
+size_t scanScalar(const char* data, size_t len, HttpScanner::State* st)
+{
+    for (uint32_t pos = st->scanned; pos < len; ++pos)
+    {
+        char c = data[pos];
+        if ((c == '\n' || c == ':') && onDelimiter(data, pos, st))
+        {
+            return pos + 1;
+        }
+    }
+    st->scanned = static_cast<uint32_t>(len);
+    return 0;
+}
+
+#ifdef HTTP_SCANNER_X86
+
+size_t scanSse2(const char* data, size_t len, HttpScanner::State* st)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i colon = _mm_set1_epi8(':');
+    size_t headLen = 0;
+    uint32_t pos = st->scanned;
+    for (; pos + 16 <= len; pos += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        uint32_t mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, colon)));
+        if (onMask(data, pos, mask, st, &headLen))
+        {
+            return headLen;
+        }
+    }
+    st->scanned = pos;
+    return scanScalar(data, len, st);
+}
+
+__attribute__((target("avx2")))
+size_t scanAvx2(const char* data, size_t len, HttpScanner::State* st)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i colon = _mm256_set1_epi8(':');
+    size_t headLen = 0;
+    uint32_t pos = st->scanned;
+    for (; pos + 32 <= len; pos += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, colon))));
+        if (onMask(data, pos, mask, st, &headLen))
+        {
+            return headLen;
+        }
+    }
+    st->scanned = pos;
+    return scanSse2(data, len, st);
+}
+
+#endif
+
+struct ScanImpl
+{
+    ScanFn      fn;
+    const char* name;
+};
+
+ScanImpl selectImpl()
+{
+#ifdef HTTP_SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {scanAvx2, "avx2"};
+    }
+    return {scanSse2, "sse2"};
+#else
+    return {scanScalar, "scalar"};
+#endif
+}
+
+const ScanImpl& impl()
+{
+    static const ScanImpl selected = selectImpl();
+    return selected;
+}
+
+} // namespace
+
+size_t HttpScanner::scanHead(const char* data, size_t len, State* state)
+{
+    return impl().fn(data, len, state);
+}
+
+const char* HttpScanner::implName()
+{
+    return impl().name;
+}
+
+} // namespace http
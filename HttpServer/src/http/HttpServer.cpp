@@ -1,4 +1,6 @@
 #include "../../include/http/HttpServer.h"
+#include "../../include/http/DateCache.h"
+#include "../../include/http/TimingWheel.h"
 
 #include <any>
 #include <functional>
@@ -7,6 +9,20 @@
 namespace http
 {
 
+namespace
+{
+
+// 超时关闭时先半关闭，对端既不读也不关闭时过这么久（秒）强制关闭
+const double kForceCloseDelay = 5.0;
+
+// 清理过期会话的周期（秒）
+const double kSessionCleanInterval = 1.0;
+
+// 响应体不大于该长度时拷贝进响应队列，与响应头一起写出；更大的响应体作为共享段直接发送
+const size_t kInlineBodyLimit = 1024;
+
+} // namespace
+
 // 默认http回应函数
 void defaultHttpCallback(const HttpRequest &, HttpResponse *resp)
 {
@@ -23,6 +39,7 @@ HttpServer::HttpServer(int port,
     , server_(&mainLoop_, listenAddr_, name, option)
     , useSSL_(useSSL)
     , httpCallback_(std::bind(&HttpServer::handleRequest, this, std::placeholders::_1, std::placeholders::_2))
+    , workerPool_(name + "-worker")
 {
     initialize();
 }
@@ -30,6 +47,7 @@ HttpServer::HttpServer(int port,
 // 服务器运行函数
 void HttpServer::start()
 {
+    workerPool_.start(workerThreadNum_);
     LOG_WARN << "HttpServer[" << server_.name() << "] starts listening on" << server_.ipPort();
     server_.start();
     mainLoop_.loop();
@@ -45,6 +63,21 @@ void HttpServer::initialize()
                   std::placeholders::_1,
                   std::placeholders::_2,
                   std::placeholders::_3));
+    server_.setWriteCompleteCallback(
+        std::bind(&HttpServer::onWriteComplete, this, std::placeholders::_1));
+    // 每个 IO 线程各自缓存 Date 响应头，由本线程的定时器每秒刷新；
+    // 连接超时由每个 IO 线程的时间轮管理
+    server_.setThreadInitCallback([](muduo::net::EventLoop *loop) {
+        DateCache::install(loop);
+        TimingWheel::install(loop);
+    });
+    // 过期会话由主循环的定时器清理，不再在每次取会话时扫描全部会话
+    mainLoop_.runEvery(kSessionCleanInterval, [this] {
+        if (sessionManager_)
+        {
+            sessionManager_->cleanExpiredSessions();
+        }
+    });
 }
 
 void HttpServer::setSslConfig(const ssl::SslConfig& config)
@@ -57,6 +90,13 @@ void HttpServer::setSslConfig(const ssl::SslConfig& config)
             LOG_ERROR << "Failed to initialize SSL context";
             abort();
         }
+        // 定期检查证书文件，更新后原子地替换证书
+        if (config.getCertificateReloadInterval() > 0)
+        {
+            mainLoop_.runEvery(config.getCertificateReloadInterval(), [this] {
+                sslCtx_->reloadCertificatesIfChanged();
+            });
+        }
     }
 }
 
@@ -64,21 +104,46 @@ void HttpServer::onConnection(const muduo::net::TcpConnectionPtr& conn)
 {
     if (conn->connected())
     {
+        // 响应头与文件响应体分两次写出，关闭 Nagle 以免响应体的最后一段等待响应头的 ACK
+        conn->setTcpNoDelay(true);
+        conn->setContext(HttpContext());
+        HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        context->setMaxBodySize(maxBodySize_);
+        context->setMaxHeaderSize(maxHeaderSize_);
+        TimingWheel *wheel = TimingWheel::of(conn->getLoop());
+        if (wheel)
+        {
+            std::weak_ptr<muduo::net::TcpConnection> weakConn(conn);
+            context->setTimeout(wheel, std::make_shared<TimingWheel::Entry>([this, weakConn] {
+                onTimeout(weakConn);
+            }));
+            // 第一个请求的请求头期限从建立连接开始计算，SSL 连接的握手也包含在内
+            armTimeout(context, HttpContext::kHeaderTimeout, headerTimeout_);
+        }
         if (useSSL_)
         {
-            auto sslConn = std::make_unique<ssl::SslConnection>(conn, sslCtx_.get());
+            // SSL 连接保存在本连接的上下文中，只由连接所属的 IO 线程访问，无需加锁
+            auto sslConn = std::make_shared<ssl::SslConnection>(conn, sslCtx_.get());
+            // 解密后的数据经回调交给 HTTP 层，握手在握手线程池完成后补读的数据也走这里
             sslConn->setMessageCallback(
-                std::bind(&HttpServer::onMessage, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-            sslConns_[conn] = std::move(sslConn);
-            sslConns_[conn]->startHandshake();
+                std::bind(&HttpServer::handleMessage, this,
+                          std::placeholders::_1,
+                          std::placeholders::_2,
+                          std::placeholders::_3));
+            context->setSslConnection(sslConn);
+            sslConn->startHandshake();
         }
-        conn->setContext(HttpContext());
     }
     else 
     {
         if (useSSL_)
         {
-            sslConns_.erase(conn);
+            // SslConnection 持有 TcpConnectionPtr，断开时释放以打破循环引用
+            HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+            if (context)
+            {
+                context->setSslConnection(nullptr);
+            }
         }
     }
 }
@@ -86,111 +151,395 @@ void HttpServer::onConnection(const muduo::net::TcpConnectionPtr& conn)
 void HttpServer::onMessage(const muduo::net::TcpConnectionPtr &conn,
                            muduo::net::Buffer *buf,
                            muduo::Timestamp receiveTime)
+{
+    // 这层判断只是代表是否支持ssl
+    HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    ssl::SslConnection *sslConn = context->sslConnection();
+    if (sslConn)
+    {
+        // SSL连接处理数据（握手或解密），解密后的数据通过回调进入 handleMessage
+        sslConn->onRead(conn, buf, receiveTime);
+        return;
+    }
+    handleMessage(conn, buf, receiveTime);
+}
+
+// 处理明文数据（未启用 SSL 时为连接的输入缓冲区，否则为 SSL 解密缓冲区）
+void HttpServer::handleMessage(const muduo::net::TcpConnectionPtr &conn,
+                               muduo::net::Buffer *buf,
+                               muduo::Timestamp receiveTime)
 {
     try
     {
-        // 这层判断只是代表是否支持ssl
-        if (useSSL_)
-        {
-            LOG_INFO << "onMessage useSSL_ is true";
-            // 1.查找对应的SSL连接
-            auto it = sslConns_.find(conn);
-            if (it != sslConns_.end())
-            {
-                LOG_INFO << "onMessage sslConns_ is not empty";
-                // 2. SSL连接处理数据
-                it->second->onRead(conn, buf, receiveTime);
-
-                // 3. 如果 SSL 握手还未完成，直接返回
-                if (!it->second->isHandshakeCompleted())
-                {
-                    LOG_INFO << "onMessage sslConns_ is not empty";
-                    return;
-                }
-
-                // 4. 从SSL连接的解密缓冲区获取数据
-                muduo::net::Buffer* decryptedBuf = it->second->getDecryptedBuffer();
-                if (decryptedBuf->readableBytes() == 0)
-                    return; // 没有解密后的数据
-
-                // 5. 使用解密后的数据进行HTTP 处理
-                buf = decryptedBuf; // 将 buf 指向解密后的数据
-                LOG_INFO << "onMessage decryptedBuf is not empty";
-            }
-        }
         // HttpContext对象用于解析出buf中的请求报文，并把报文的关键信息封装到HttpRequest对象中
         HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+        processRequests(conn, context, buf, receiveTime);
+    }
+    catch (const std::exception &e)
+    {
+        // 捕获异常，返回错误信息
+        LOG_ERROR << "Exception in onMessage: " << e.what();
+        conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
+        conn->shutdown();
+    }
+}
+
+// 依次处理buf中所有完整的请求（客户端可能流水线发送多个请求）
+void HttpServer::processRequests(const muduo::net::TcpConnectionPtr &conn,
+                                 HttpContext *context,
+                                 muduo::net::Buffer *buf,
+                                 muduo::Timestamp receiveTime)
+{
+    muduo::net::Buffer *output = context->outputQueue();
+    bool close = false;
+    // 分块发送或等待延迟响应期间后续请求留在buf中，响应发送完成后再处理
+    while (!close && !context->busy())
+    {
         if (!context->parseRequest(buf, receiveTime)) // 解析一个http请求
         {
-            // 如果解析http报文过程中出错
-            conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
-            conn->shutdown();
+            // 如果解析http报文过程中出错，返回对应的错误后关闭连接，请求体的边界已不可信
+            HttpResponse error(true);
+            error.setStatusCode(context->errorStatus());
+            error.setContentLength(0);
+            error.appendToBuffer(output);
+            close = true;
+            break;
         }
         // 如果buf缓冲区中解析出一个完整的数据包才封装响应报文
-        if (context->gotAll())
+        if (!context->gotAll())
         {
-            onRequest(conn, context->request());
-            context->reset();
+            break;
+        }
+        close = onRequest(conn, context, buf);
+        context->reset();
+    }
+
+    // 本批请求的响应按顺序一次性发送
+    sendOutput(conn, context);
+    // 如果是短连接的话，返回响应报文后就断开连接
+    if (close)
+    {
+        conn->shutdown();
+    }
+    else
+    {
+        updateTimeout(context, buf);
+    }
+}
+
+// 上一段数据写完后继续生成分块响应的下一段
+void HttpServer::onWriteComplete(const muduo::net::TcpConnectionPtr &conn)
+{
+    HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    if (!context || !context->streaming())
+    {
+        return;
+    }
+
+    try
+    {
+        bool more = context->produceChunk();
+        sendOutput(conn, context);
+        if (more)
+        {
+            return;
         }
     }
     catch (const std::exception &e)
     {
-        // 捕获异常，返回错误信息
-        LOG_ERROR << "Exception in onMessage: " << e.what();
-        conn->send("HTTP/1.1 400 Bad Request\r\n\r\n");
+        // 响应头已经发出，无法再返回错误响应，只能断开连接
+        LOG_ERROR << "Exception in chunk producer: " << e.what();
+        conn->shutdown();
+        return;
+    }
+
+    if (context->streamClose())
+    {
         conn->shutdown();
     }
+    else if (context->pendingInput()->readableBytes() > 0)
+    {
+        // 继续处理分块发送期间到达的流水线请求
+        processRequests(conn, context, context->pendingInput(), muduo::Timestamp::now());
+    }
+    else
+    {
+        updateTimeout(context, context->pendingInput());
+    }
 }
 
-void HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn, const HttpRequest &req)
+// 处理一个请求并将响应追加到响应队列，返回是否需要关闭连接
+bool HttpServer::onRequest(const muduo::net::TcpConnectionPtr &conn,
+                           HttpContext *context,
+                           muduo::net::Buffer *input)
 {
-    const std::string &connection = req.getHeader("Connection");
-    bool close = ((connection == "close") ||
-                  (req.getVersion() == "HTTP/1.0" && connection != "Keep-Alive"));
+    // 请求在分发期间原地修改，不再复制
+    HttpRequest &req = context->request();
+    std::string_view connection = req.getHeader(HttpRequest::kConnection);
+    bool close = (equalsIgnoreCase(connection, "close") ||
+                  (req.getVersion() == "HTTP/1.0" && !equalsIgnoreCase(connection, "Keep-Alive")));
+    // 达到每个连接的请求数上限时，在本次响应中关闭连接
+    if (context->countRequest() >= maxRequestsPerConnection_ && maxRequestsPerConnection_ > 0)
+    {
+        close = true;
+    }
+    bool chunked = (req.getVersion() == "HTTP/1.1"); // HTTP/1.0 不支持分块编码
     HttpResponse response(close);
 
+    // 处理器可以把响应转为延迟响应，在其他线程完成后回到本连接的 EventLoop 发送
+    std::weak_ptr<muduo::net::TcpConnection> weakConn(conn);
+    muduo::net::EventLoop *loop = conn->getLoop();
+    // 连接在处理器返回前就进入等待状态，完成回调总是经 queueInLoop 在其后执行
+    response.setDeferHook([this, weakConn, loop, chunked, context, input](HttpResponse *resp) {
+        context->startDeferred(input);
+        return std::make_shared<ResponseWriter>(loop, std::move(*resp),
+            [this, weakConn, chunked](HttpResponse *deferred) {
+                onDeferredDone(weakConn, deferred, chunked);
+            });
+    });
+
     // 根据请求报文信息来封装响应报文对象
     httpCallback_(req, &response); // 执行onHttpCallback函数
 
-    // 可以给response设置一个成员，判断是否请求的是文件，如果是文件设置为true，并且存在文件位置在这里send出去。
-    muduo::net::Buffer buf;
-    response.appendToBuffer(&buf);
-    // 打印完整的响应内容用于调试
-    LOG_INFO << "Sending response:\n" << buf.toStringPiece().as_string();
+    if (response.isDeferred())
+    {
+        return false;
+    }
+    return writeResponse(context, &response, chunked, input);
+}
 
-    conn->send(&buf);
-    // 如果是短连接的话，返回响应报文后就断开连接
-    if (response.closeConnection())
+// 延迟响应完成，在连接所属的 EventLoop 中发送
+void HttpServer::onDeferredDone(const std::weak_ptr<muduo::net::TcpConnection> &weakConn,
+                                HttpResponse *response,
+                                bool chunked)
+{
+    muduo::net::TcpConnectionPtr conn = weakConn.lock();
+    if (!conn || !conn->connected())
+    {
+        return; // 连接已断开，丢弃响应
+    }
+
+    HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    middlewareChain_.processAfter(*response);
+    context->finishDeferred();
+
+    bool close = writeResponse(context, response, chunked, context->pendingInput());
+    sendOutput(conn, context);
+
+    if (close)
     {
         conn->shutdown();
     }
+    else if (!context->busy() && context->pendingInput()->readableBytes() > 0)
+    {
+        // 继续处理等待期间到达的流水线请求
+        processRequests(conn, context, context->pendingInput(), muduo::Timestamp::now());
+    }
+    else
+    {
+        updateTimeout(context, context->pendingInput());
+    }
+}
+
+// 发送响应队列中的数据，SSL 连接先加密再发送
+void HttpServer::sendOutput(const muduo::net::TcpConnectionPtr &conn, HttpContext *context)
+{
+    muduo::net::Buffer *output = context->outputQueue();
+    std::vector<HttpContext::QueuedBody> &bodies = context->queuedBodies();
+    if (output->readableBytes() == 0 && bodies.empty())
+    {
+        return;
+    }
+
+    ssl::SslConnection *sslConn = context->sslConnection();
+    if (sslConn)
+    {
+        // 共享响应体直接从其所在内存（如文件映射、模板片段）加密，响应队列按响应体的插入位置分段；
+        // 各段攒成满记录再加密，整批密文最后一次交给连接
+        size_t sent = 0;
+        for (const HttpContext::QueuedBody &queued : bodies)
+        {
+            sslConn->write(output->peek() + sent, queued.offset - sent);
+            sent = queued.offset;
+            sslConn->write(queued.body.data, queued.body.size);
+        }
+        sslConn->write(output->peek() + sent, output->readableBytes() - sent);
+        sslConn->flush();
+        output->retrieveAll();
+        bodies.clear();
+        return;
+    }
+
+    // 明文连接：muduo 的 TcpConnection 不暴露 socket fd，无法用 writev 一次写出，
+    // 响应队列的各段和共享响应体依次交给 send，不经中间缓冲区拷贝；
+    // muduo 在输出缓冲区为空时直接写 socket，写不完的部分才进入输出缓冲区
+    size_t sent = 0;
+    for (const HttpContext::QueuedBody &queued : bodies)
+    {
+        if (queued.offset > sent)
+        {
+            conn->send(output->peek() + sent, static_cast<int>(queued.offset - sent));
+        }
+        sent = queued.offset;
+        conn->send(queued.body.data, static_cast<int>(queued.body.size));
+    }
+    output->retrieve(sent);
+    if (output->readableBytes() > 0)
+    {
+        conn->send(output);
+    }
+    bodies.clear();
+}
+
+// 根据读请求的进度设置本连接的期限，每次收到数据或发完响应时调用
+void HttpServer::updateTimeout(HttpContext *context, muduo::net::Buffer *input)
+{
+    if (!context->timeout())
+    {
+        return;
+    }
+    if (context->busy())
+    {
+        // 正在生成或发送响应，等待的是服务器自己，不设期限
+        armTimeout(context, HttpContext::kNoTimeout, 0);
+    }
+    else if (context->readingHeaders(input))
+    {
+        // 请求头期限从请求开始计算，不因陆续到达的数据延长，慢速发送请求头的连接会按时关闭
+        if (context->timeoutPhase() != HttpContext::kHeaderTimeout || !context->timeoutForCurrentRequest())
+        {
+            armTimeout(context, HttpContext::kHeaderTimeout, headerTimeout_);
+        }
+    }
+    else if (context->readingBody())
+    {
+        armTimeout(context, HttpContext::kBodyTimeout, bodyTimeout_);
+    }
+    else
+    {
+        armTimeout(context, HttpContext::kIdleTimeout, idleTimeout_);
+    }
+}
+
+void HttpServer::armTimeout(HttpContext *context, HttpContext::TimeoutPhase phase, double seconds)
+{
+    TimingWheel *wheel = context->timeoutWheel();
+    if (!wheel)
+    {
+        return;
+    }
+    context->setTimeoutPhase(phase);
+    if (phase != HttpContext::kNoTimeout && seconds > 0)
+    {
+        wheel->schedule(context->timeout(), seconds);
+    }
+    else
+    {
+        wheel->cancel(context->timeout());
+    }
+}
+
+// 连接的期限已到：读请求超时返回 408，空闲超时直接关闭
+void HttpServer::onTimeout(const std::weak_ptr<muduo::net::TcpConnection> &weakConn)
+{
+    muduo::net::TcpConnectionPtr conn = weakConn.lock();
+    if (!conn || !conn->connected())
+    {
+        return;
+    }
+    HttpContext *context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    if (context->timeoutPhase() == HttpContext::kIdleTimeout)
+    {
+        LOG_INFO << "Closing idle connection " << conn->name();
+    }
+    else
+    {
+        LOG_WARN << "Request timeout on " << conn->name();
+        // 还在握手的 SSL 连接无法发送响应
+        ssl::SslConnection *sslConn = context->sslConnection();
+        if (!context->busy() && (!sslConn || sslConn->isHandshakeCompleted()))
+        {
+            context->outputQueue()->append("HTTP/1.1 408 Request Timeout\r\nConnection: close\r\n\r\n");
+            sendOutput(conn, context);
+        }
+    }
+    conn->shutdown();
+    conn->forceCloseWithDelay(kForceCloseDelay);
+}
+
+// 将响应追加到响应队列，返回是否需要关闭连接
+bool HttpServer::writeResponse(HttpContext *context,
+                               HttpResponse *response,
+                               bool chunked,
+                               muduo::net::Buffer *input)
+{
+    muduo::net::Buffer *output = context->outputQueue();
+    if (response->isChunked())
+    {
+        // HTTP/1.0 直接写出响应体并以关闭连接标识结束
+        if (chunked)
+        {
+            response->addHeader("Transfer-Encoding", "chunked");
+        }
+        else
+        {
+            response->setCloseConnection(true);
+        }
+        // 响应头随本批响应一起发出，响应体由写完成回调驱动逐段生成
+        context->startStream(std::move(response->chunkProducer()), chunked,
+                             response->closeConnection(), input);
+        response->appendToBuffer(output);
+        response->notifyWritten();
+        return false;
+    }
+
+    // 较大的响应体和共享响应体不进入响应队列，只记录位置，发送时直接写出
+    size_t begin = output->readableBytes();
+    if (response->bodySize() > kInlineBodyLimit)
+    {
+        response->shareBody();
+    }
+    response->appendToBuffer(output);
+    for (const HttpResponse::SharedBody &segment : response->bodySegments())
+    {
+        context->queueBody(segment);
+    }
+    // 打印响应队列中的响应内容用于调试
+    LOG_INFO << "Sending response:\n"
+             << muduo::StringPiece(output->peek() + begin, static_cast<int>(output->readableBytes() - begin));
+
+    response->notifyWritten();
+    return response->closeConnection();
 }
 
 // 执行请求对应的路由处理函数
-void HttpServer::handleRequest(const HttpRequest &req, HttpResponse *resp)
+void HttpServer::handleRequest(HttpRequest &req, HttpResponse *resp)
 {
     try
     {
-        // 处理请求前的中间件
-        HttpRequest mutableReq = req;
-        middlewareChain_.processBefore(mutableReq);
+        // 处理请求前的中间件，直接修改连接上下文中的请求
+        middlewareChain_.processBefore(req);
 
         // 路由处理
-        if (!router_.route(mutableReq, resp))
+        if (!router_.route(req, resp))
         {
-            LOG_INFO << "请求的啥，url：" << req.method() << " " << req.path();
+            LOG_INFO << "请求的啥，url：" << req.method() << " " << std::string(req.path());
             LOG_INFO << "未找到路由，返回404";
             resp->setStatusCode(HttpResponse::k404NotFound);
             resp->setStatusMessage("Not Found");
             resp->setCloseConnection(true);
         }
 
-        // 处理响应后的中间件
-        middlewareChain_.processAfter(*resp);
+        // 处理响应后的中间件，延迟响应在完成时再处理
+        if (!resp->isDeferred())
+        {
+            middlewareChain_.processAfter(*resp);
+        }
     }
     catch (const HttpResponse& res) 
     {
-        // 处理中间件抛出的响应（如CORS预检请求）
+        // 处理中间件抛出的响应（如CORS预检请求），原响应连同其监听器一起被替换，先通知持有者停止写入
+        resp->notifyWritten();
         *resp = res;
     }
     catch (const std::exception& e) 
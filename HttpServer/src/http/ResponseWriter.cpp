@@ -0,0 +1,37 @@
+#include "../../include/http/ResponseWriter.h"
+
+namespace http
+{
+
+ResponseWriter::~ResponseWriter()
+{
+    // 处理器没有调用 done() 就放弃了响应，返回500避免连接一直等待
+    if (!done_)
+    {
+        response_.setStatusLine("HTTP/1.1", HttpResponse::k500InternalServerError, "Internal Server Error");
+        response_.setBody("");
+        response_.setChunkedBody(nullptr);
+        response_.setContentLength(0);
+        response_.setCloseConnection(true);
+        loop_->queueInLoop([cb = doneCallback_, response = response_]() mutable {
+            cb(&response);
+        });
+    }
+}
+
+void ResponseWriter::done()
+{
+    if (done_.exchange(true))
+    {
+        return;
+    }
+
+    // 持有自身的引用，保证回到 EventLoop 执行时对象仍然有效
+    // 总是排队执行：即使在 IO 线程中同步完成，也要等当前请求的处理流程结束后再发送
+    auto self = shared_from_this();
+    loop_->queueInLoop([self]() {
+        self->doneCallback_(&self->response_);
+    });
+}
+
+} // namespace http
@@ -0,0 +1,316 @@
+#include "../../include/http/StaticAssetCache.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+#include <brotli/encode.h>
+#include <muduo/base/Logging.h>
+#include <zlib.h>
+
+namespace http
+{
+
+static const char* const kEncodingNames[StaticAssetCache::kEncodingCount] = {"", "gzip", "br"};
+static const char* const kEtagSuffixes[StaticAssetCache::kEncodingCount] = {"", "-gz", "-br"};
+
+static bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+    {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+    {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+// 依次对逗号分隔列表中的每一项调用 f
+template <typename F>
+static void forEachListItem(std::string_view list, F&& f)
+{
+    while (!list.empty())
+    {
+        size_t comma = list.find(',');
+        std::string_view item = trim(list.substr(0, comma));
+        if (!item.empty())
+        {
+            f(item);
+        }
+        if (comma == std::string_view::npos)
+        {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+}
+
+static const char* contentTypeOf(const std::string& path)
+{
+    static const std::pair<const char*, const char*> kTypes[] = {
+        {".html", "text/html; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".js", "application/javascript; charset=utf-8"},
+        {".json", "application/json"},
+        {".svg", "image/svg+xml"},
+        {".txt", "text/plain; charset=utf-8"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".ico", "image/x-icon"},
+    };
+    for (const auto& type : kTypes)
+    {
+        if (endsWith(path, type.first))
+        {
+            return type.second;
+        }
+    }
+    return "application/octet-stream";
+}
+
+// 图片等已压缩的格式不再压缩
+static bool compressible(const std::string& contentType)
+{
+    return contentType.compare(0, 5, "text/") == 0
+        || contentType.compare(0, 22, "application/javascript") == 0
+        || contentType.compare(0, 16, "application/json") == 0
+        || contentType.compare(0, 13, "image/svg+xml") == 0;
+}
+
+static std::string gzipCompress(const std::string& data)
+{
+    z_stream zs{};
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return std::string();
+    }
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    int ret = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END ? out : std::string();
+}
+
+static std::string brotliCompress(const std::string& data)
+{
+    size_t size = BrotliEncoderMaxCompressedSize(data.size());
+    if (size == 0)
+    {
+        return std::string();
+    }
+    std::string out(size, '\0');
+    if (!BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                               data.size(), reinterpret_cast<const uint8_t*>(data.data()),
+                               &size, reinterpret_cast<uint8_t*>(&out[0])))
+    {
+        return std::string();
+    }
+    out.resize(size);
+    return out;
+}
+
+static std::string httpDate(time_t t)
+{
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[32];
+    strftime(buf, sizeof buf, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buf;
+}
+
+// 原文内容的 FNV-1a 散列作为 ETag 的主体
+static std::string contentTag(const std::string& data)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char buf[32];
+    snprintf(buf, sizeof buf, "%016llx-%zx", static_cast<unsigned long long>(hash), data.size());
+    return buf;
+}
+
+size_t StaticAssetCache::loadDirectory(const std::string& dir, const std::string& extension)
+{
+    DIR* d = opendir(dir.c_str());
+    if (!d)
+    {
+        LOG_WARN << "Static asset directory " << dir << " not exist";
+        return 0;
+    }
+    size_t loaded = 0;
+    while (struct dirent* entry = readdir(d))
+    {
+        std::string name(entry->d_name);
+        if (endsWith(name, extension) && load(dir + "/" + name))
+        {
+            ++loaded;
+        }
+    }
+    closedir(d);
+    return loaded;
+}
+
+bool StaticAssetCache::load(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        return false;
+    }
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto asset = std::make_shared<Asset>();
+    asset->contentType = contentTypeOf(path);
+    asset->lastModified = httpDate(st.st_mtime);
+    if (compressible(asset->contentType))
+    {
+        asset->variants[kGzip].body = gzipCompress(content);
+        asset->variants[kBrotli].body = brotliCompress(content);
+    }
+    asset->variants[kIdentity].body = std::move(content);
+
+    const std::string& identity = asset->variants[kIdentity].body;
+    std::string tag = contentTag(identity);
+    for (int i = 0; i < kEncodingCount; ++i)
+    {
+        Variant& variant = asset->variants[i];
+        // 压缩后没有变小的编码不提供
+        if (i != kIdentity && variant.body.size() >= identity.size())
+        {
+            variant.body.clear();
+            continue;
+        }
+        variant.etag = "\"" + tag + kEtagSuffixes[i] + "\"";
+    }
+
+    LOG_INFO << "Static asset " << path << " loaded: " << identity.size() << " bytes, gzip "
+             << asset->variants[kGzip].body.size() << ", br " << asset->variants[kBrotli].body.size();
+    assets_[path] = std::move(asset);
+    return true;
+}
+
+std::shared_ptr<const StaticAssetCache::Asset> StaticAssetCache::find(const std::string& path) const
+{
+    auto it = assets_.find(path);
+    return it == assets_.end() ? nullptr : it->second;
+}
+
+StaticAssetCache::Encoding StaticAssetCache::selectEncoding(std::string_view acceptEncoding, const Asset& asset)
+{
+    // 未出现的编码取 "*" 的权重，都未出现时不可接受
+    double qBrotli = -1, qGzip = -1, qAny = -1;
+    forEachListItem(acceptEncoding, [&](std::string_view item) {
+        size_t semicolon = item.find(';');
+        std::string_view coding = trim(item.substr(0, semicolon));
+        double q = 1;
+        if (semicolon != std::string_view::npos)
+        {
+            std::string_view param = trim(item.substr(semicolon + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+            {
+                q = strtod(std::string(param.substr(2)).c_str(), nullptr);
+            }
+        }
+        if (equalsIgnoreCase(coding, "br"))
+        {
+            qBrotli = q;
+        }
+        else if (equalsIgnoreCase(coding, "gzip") || equalsIgnoreCase(coding, "x-gzip"))
+        {
+            qGzip = q;
+        }
+        else if (coding == "*")
+        {
+            qAny = q;
+        }
+    });
+    if (qBrotli < 0)
+    {
+        qBrotli = qAny;
+    }
+    if (qGzip < 0)
+    {
+        qGzip = qAny;
+    }
+
+    bool hasBrotli = !asset.variants[kBrotli].body.empty() && qBrotli > 0;
+    bool hasGzip = !asset.variants[kGzip].body.empty() && qGzip > 0;
+    if (hasBrotli && (!hasGzip || qBrotli >= qGzip))
+    {
+        return kBrotli;
+    }
+    return hasGzip ? kGzip : kIdentity;
+}
+
+bool StaticAssetCache::serve(const std::string& path, const HttpRequest& req, HttpResponse* resp) const
+{
+    auto it = assets_.find(path);
+    if (it == assets_.end())
+    {
+        return false;
+    }
+    const std::shared_ptr<const Asset>& asset = it->second;
+    Encoding encoding = selectEncoding(req.getHeader(HttpRequest::kAcceptEncoding), *asset);
+    const Variant& variant = asset->variants[encoding];
+
+    resp->addHeader("ETag", variant.etag);
+    resp->addHeader("Last-Modified", asset->lastModified);
+    resp->addHeader("Vary", "Accept-Encoding");
+
+    // If-None-Match 优先于 If-Modified-Since，弱比较
+    bool notModified = false;
+    std::string_view ifNoneMatch = req.getHeader("If-None-Match");
+    if (!ifNoneMatch.empty())
+    {
+        forEachListItem(ifNoneMatch, [&](std::string_view tag) {
+            if (tag.substr(0, 2) == "W/")
+            {
+                tag.remove_prefix(2);
+            }
+            notModified = notModified || tag == "*" || tag == variant.etag;
+        });
+    }
+    else
+    {
+        notModified = req.getHeader("If-Modified-Since") == asset->lastModified;
+    }
+    if (notModified)
+    {
+        resp->setStatusLine(req.getVersion(), HttpResponse::k304NotModified, "Not Modified");
+        return true;
+    }
+
+    resp->setStatusLine(req.getVersion(), HttpResponse::k200Ok, "OK");
+    resp->setContentType(asset->contentType);
+    if (encoding != kIdentity)
+    {
+        resp->addHeader("Content-Encoding", kEncodingNames[encoding]);
+    }
+    resp->setSharedBody(asset, variant.body.data(), variant.body.size());
+    return true;
+}
+
+} // namespace http
@@ -0,0 +1,82 @@
+#include "../../include/http/TimingWheel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace http
+{
+
+namespace
+{
+
+// 每个 IO 线程的时间轮放在线程局部变量中，不占用 EventLoop 唯一的上下文
+thread_local std::shared_ptr<TimingWheel> loopWheel;
+thread_local muduo::net::EventLoop*       wheelLoop = nullptr;
+
+} // namespace
+
+void TimingWheel::install(muduo::net::EventLoop* loop, double tickSeconds, int slots)
+{
+    // 时间轮由本线程和定时器共同持有，与 loop 同生命周期
+    auto wheel = std::make_shared<TimingWheel>(tickSeconds, slots);
+    loopWheel = wheel;
+    wheelLoop = loop;
+    loop->runEvery(tickSeconds, [wheel] { wheel->tick(); });
+}
+
+TimingWheel* TimingWheel::of(muduo::net::EventLoop* loop)
+{
+    return wheelLoop == loop ? loopWheel.get() : nullptr;
+}
+
+TimingWheel::TimingWheel(double tickSeconds, int slots)
+    : tickSeconds_(tickSeconds)
+    , slots_(slots)
+{
+}
+
+void TimingWheel::schedule(const EntryPtr& entry, double seconds)
+{
+    int64_t ticks = static_cast<int64_t>(std::ceil(seconds / tickSeconds_));
+    int64_t deadline = now_ + std::max<int64_t>(ticks, 1);
+    if (entry->deadline_ == deadline)
+    {
+        return;
+    }
+    entry->deadline_ = deadline;
+    ++entry->generation_;
+    slots_[deadline % slots_.size()].emplace_back(entry, entry->generation_);
+}
+
+void TimingWheel::cancel(const EntryPtr& entry)
+{
+    entry->deadline_ = -1;
+    ++entry->generation_;
+}
+
+void TimingWheel::tick()
+{
+    ++now_;
+    // 先把本槽换出，回调中重新设置的期限不会落入正在遍历的容器
+    std::vector<Record>& slot = slots_[now_ % slots_.size()];
+    expiring_.swap(slot);
+    for (const Record& record : expiring_)
+    {
+        EntryPtr entry = record.first.lock();
+        if (!entry || entry->generation_ != record.second)
+        {
+            continue; // 连接已销毁或已改期
+        }
+        if (entry->deadline_ > now_)
+        {
+            slot.push_back(record); // 期限超过一圈，留到之后的轮次
+            continue;
+        }
+        entry->deadline_ = -1;
+        ++entry->generation_;
+        entry->callback_();
+    }
+    expiring_.clear();
+}
+
+} // namespace http
@@ -0,0 +1,294 @@
+#include "../../include/router/RouteTree.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace http
+{
+namespace router
+{
+
+struct RouteTree::Node
+{
+    std::string                        path;     // 静态节点：压缩后的路径片段
+    std::string                        indices;  // 各静态子节点 path 的首字符，用于快速选择分支
+    std::vector<std::unique_ptr<Node>> children; // 静态子节点，首字符互不相同
+    std::vector<std::unique_ptr<Node>> params;   // 参数子节点，带类型约束的排在前面
+    std::unique_ptr<Node>              wildcard; // 通配子节点
+    std::string                        name;     // 参数/通配节点的参数名
+    ParamType                          type = ParamType::kString;
+    int                                routeId = -1;
+};
+
+RouteTree::RouteTree()
+    : root_(new Node)
+{}
+
+RouteTree::~RouteTree() = default;
+
+int RouteTree::insert(const std::string& pattern, int routeId)
+{
+    Node* node = root_.get();
+    size_t pos = 0;
+    while (pos < pattern.size())
+    {
+        char c = pattern[pos];
+        bool segmentBegin = pos > 0 && pattern[pos - 1] == '/';
+        if (segmentBegin && c == ':')
+        {
+            size_t end = pattern.find('/', pos);
+            if (end == std::string::npos)
+            {
+                end = pattern.size();
+            }
+            std::string name = pattern.substr(pos + 1, end - pos - 1);
+            ParamType type = ParamType::kString;
+            size_t lt = name.find('<');
+            if (lt != std::string::npos)
+            {
+                if (name.back() != '>')
+                {
+                    throw std::invalid_argument("bad route parameter: " + pattern);
+                }
+                std::string typeName = name.substr(lt + 1, name.size() - lt - 2);
+                if (typeName == "int")
+                {
+                    type = ParamType::kInt;
+                }
+                else if (typeName == "uuid")
+                {
+                    type = ParamType::kUuid;
+                }
+                else if (typeName != "string")
+                {
+                    throw std::invalid_argument("unknown route parameter type: " + pattern);
+                }
+                name.resize(lt);
+            }
+            if (name.empty())
+            {
+                throw std::invalid_argument("empty route parameter name: " + pattern);
+            }
+            node = insertParam(node, name, type);
+            pos = end;
+        }
+        else if (segmentBegin && c == '*')
+        {
+            std::string name = pattern.substr(pos + 1);
+            if (name.empty() || name.find('/') != std::string::npos)
+            {
+                throw std::invalid_argument("wildcard must be the last segment: " + pattern);
+            }
+            if (!node->wildcard)
+            {
+                node->wildcard.reset(new Node);
+                node->wildcard->name = name;
+            }
+            else if (node->wildcard->name != name)
+            {
+                throw std::invalid_argument("conflicting wildcard name: " + pattern);
+            }
+            node = node->wildcard.get();
+            pos = pattern.size();
+        }
+        else
+        {
+            // 静态片段一直延伸到下一个参数/通配段之前
+            size_t end = pos + 1;
+            while (end < pattern.size()
+                   && !(pattern[end - 1] == '/' && (pattern[end] == ':' || pattern[end] == '*')))
+            {
+                ++end;
+            }
+            node = insertStatic(node, std::string_view(pattern).substr(pos, end - pos));
+            pos = end;
+        }
+    }
+    if (node->routeId < 0)
+    {
+        node->routeId = routeId;
+    }
+    return node->routeId;
+}
+
+RouteTree::Node* RouteTree::insertStatic(Node* node, std::string_view path)
+{
+    while (!path.empty())
+    {
+        size_t i = node->indices.find(path[0]);
+        if (i == std::string::npos)
+        {
+            std::unique_ptr<Node> child(new Node);
+            child->path.assign(path.data(), path.size());
+            node->indices.push_back(path[0]);
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+
+        Node* child = node->children[i].get();
+        size_t common = 0;
+        size_t limit = std::min(child->path.size(), path.size());
+        while (common < limit && child->path[common] == path[common])
+        {
+            ++common;
+        }
+
+        // 只有部分公共前缀时拆分子节点：公共前缀成为新的中间节点
+        if (common < child->path.size())
+        {
+            std::unique_ptr<Node> middle(new Node);
+            middle->path = child->path.substr(0, common);
+            std::unique_ptr<Node> rest = std::move(node->children[i]);
+            rest->path.erase(0, common);
+            middle->indices.push_back(rest->path[0]);
+            middle->children.push_back(std::move(rest));
+            node->children[i] = std::move(middle);
+            child = node->children[i].get();
+        }
+
+        node = child;
+        path.remove_prefix(common);
+    }
+    return node;
+}
+
+RouteTree::Node* RouteTree::insertParam(Node* node, const std::string& name, ParamType type)
+{
+    for (auto& param : node->params)
+    {
+        if (param->type == type)
+        {
+            if (param->name != name)
+            {
+                throw std::invalid_argument("conflicting route parameter name: " + name);
+            }
+            return param.get();
+        }
+    }
+
+    std::unique_ptr<Node> param(new Node);
+    param->name = name;
+    param->type = type;
+    // 带类型约束的参数先尝试，不受约束的 kString 放在最后兜底
+    auto it = std::find_if(node->params.begin(), node->params.end(),
+        [](const std::unique_ptr<Node>& p) { return p->type == ParamType::kString; });
+    return node->params.insert(it, std::move(param))->get();
+}
+
+int RouteTree::match(std::string_view path, Params* params) const
+{
+    int routeId = -1;
+    params->clear();
+    if (!matchNode(root_.get(), path, params, &routeId))
+    {
+        params->clear();
+        return -1;
+    }
+    return routeId;
+}
+
+// node 自身的片段已被调用者消耗，path 为剩余部分
+bool RouteTree::matchNode(const Node* node, std::string_view path, Params* params, int* routeId)
+{
+    if (path.empty() && node->routeId >= 0)
+    {
+        *routeId = node->routeId;
+        return true;
+    }
+
+    if (!path.empty())
+    {
+        // 静态子节点首字符互不相同，最多只有一个候选
+        size_t i = node->indices.find(path[0]);
+        if (i != std::string::npos)
+        {
+            const Node* child = node->children[i].get();
+            if (path.compare(0, child->path.size(), child->path) == 0
+                && matchNode(child, path.substr(child->path.size()), params, routeId))
+            {
+                return true;
+            }
+        }
+
+        if (!node->params.empty())
+        {
+            std::string_view segment = path.substr(0, path.find('/'));
+            if (!segment.empty())
+            {
+                for (const auto& param : node->params)
+                {
+                    if (!checkType(param->type, segment))
+                    {
+                        continue;
+                    }
+                    params->emplace_back(param->name, segment);
+                    if (matchNode(param.get(), path.substr(segment.size()), params, routeId))
+                    {
+                        return true;
+                    }
+                    params->pop_back();
+                }
+            }
+        }
+    }
+
+    if (node->wildcard && node->wildcard->routeId >= 0)
+    {
+        params->emplace_back(node->wildcard->name, path);
+        *routeId = node->wildcard->routeId;
+        return true;
+    }
+    return false;
+}
+
+bool RouteTree::checkType(ParamType type, std::string_view value)
+{
+    switch (type)
+    {
+    case ParamType::kInt:
+    {
+        size_t i = (value[0] == '-') ? 1 : 0;
+        if (i == value.size())
+        {
+            return false;
+        }
+        for (; i < value.size(); ++i)
+        {
+            if (value[i] < '0' || value[i] > '9')
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    case ParamType::kUuid:
+    {
+        // 8-4-4-4-12 个十六进制字符
+        if (value.size() != 36)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            char c = value[i];
+            if (i == 8 || i == 13 || i == 18 || i == 23)
+            {
+                if (c != '-')
+                {
+                    return false;
+                }
+            }
+            else if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    default:
+        return true;
+    }
+}
+
+} // namespace router
+} // namespace http
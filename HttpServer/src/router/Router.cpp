@@ -8,72 +8,49 @@ namespace router
 
 void Router::registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
 {
-    RouteKey key{method, path};
-    handlers_[key] = std::move(handler);
+    findOrAddRoute(method, path).handler = std::move(handler);
 }
 
 void Router::registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
 {
-    RouteKey key{method, path};
-    callbacks_[key] = std::move(callback);
+    findOrAddRoute(method, path).callback = callback;
 }
 
-bool Router::route(const HttpRequest &req, HttpResponse *resp)
+Router::Route& Router::findOrAddRoute(HttpRequest::Method method, const std::string &path)
 {
-    RouteKey key{req.method(), req.path()};
-
-    // 查找处理器
-    auto handlerIt = handlers_.find(key);
-    if (handlerIt != handlers_.end())
+    // 同一模式重复注册时复用原来的表项，处理器与回调函数可以共存
+    int next = static_cast<int>(routes_.size());
+    int id = trees_[method].insert(path, next);
+    if (id == next)
     {
-        handlerIt->second->handle(req, resp);
-        return true;
+        routes_.emplace_back();
     }
+    return routes_[id];
+}
 
-    // 查找回调函数
-    auto callbackIt = callbacks_.find(key);
-    if (callbackIt != callbacks_.end())
+bool Router::route(HttpRequest &req, HttpResponse *resp)
+{
+    RouteTree::Params params;
+    int id = trees_[req.method()].match(req.path(), &params);
+    if (id < 0)
     {
-        callbackIt->second(req, resp);
-        return true;
+        return false;
     }
 
-    // 查找动态路由处理器
-    for (const auto &[method, pathRegex, handler] : regexHandlers_)
+    const Route &route = routes_[id];
+    extractPathParameters(params, req);
+
+    // 处理器优先于回调函数
+    if (route.handler)
     {
-        std::smatch match;
-        std::string pathStr(req.path());
-        // 如果方法匹配并且动态路由匹配，则执行处理器
-        if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
-        {
-            // Extract path parameters and add them to the request
-            HttpRequest newReq(req); // 因为这里需要用这一次所以是可以改的
-            extractPathParameters(match, newReq);
-            
-            handler->handle(newReq, resp);
-            return true;
-        }
+        route.handler->handle(req, resp);
     }
-
-    // 查找动态路由回调函数
-    for (const auto &[method, pathRegex, callback] : regexCallbacks_)
+    else
     {
-        std::smatch match;
-        std::string pathStr(req.path());
-        // 如果方法匹配并且动态路由匹配，则执行回调函数
-        if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
-        {
-             // Extract path parameters and add them to the request
-            HttpRequest newReq(req); // 因为这里需要用这一次所以是可以改的
-            extractPathParameters(match, newReq);
-
-            callback(req, resp);
-            return true;
-        }
+        route.callback(req, resp);
     }
-
-    return false;
+    return true;
 }
 
 } // namespace router
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -0,0 +1,575 @@
+#include "../include/session/PersistentSessionStorage.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#include <muduo/base/Logging.h>
+#include <zlib.h>
+
+namespace http
+{
+namespace session
+{
+
+// 日志文件格式（本机字节序）：
+//   文件头    kMagic
+//   记录      [u32 长度][u32 crc32][u8 类型][内容]，长度与 crc32 都只针对 类型+内容
+//   保存记录  [u16 ID长度][ID][i64 过期时间(毫秒)][i32 maxAge][u32 项数]{[u32 键长][键][u32 值长][值]}
+//   删除记录  [u16 ID长度][ID]
+// 文件预先扩展并以 0 填充，长度为 0 的记录表示日志结束
+static const char   kMagic[8] = {'H', 'S', 'E', 'S', 'L', 'O', 'G', '1'};
+static const size_t kHeaderSize = sizeof kMagic;
+static const size_t kRecordHeaderSize = 8;
+static const size_t kInitialCapacity = 1 << 20;
+static const size_t kCompactMinSize = 4 << 20; // 日志小于该长度时不重写
+
+enum RecordType : uint8_t
+{
+    kSaveRecord = 1,
+    kRemoveRecord = 2,
+};
+
+using Clock = std::chrono::system_clock;
+
+template <typename T>
+static void put(std::string* out, T value)
+{
+    out->append(reinterpret_cast<const char*>(&value), sizeof value);
+}
+
+static void putString(std::string* out, const std::string& s)
+{
+    put<uint32_t>(out, static_cast<uint32_t>(s.size()));
+    out->append(s);
+}
+
+// 在 out 末尾追加一条完整的记录，body 为 类型+内容
+static void appendRecord(std::string* out, const std::string& body)
+{
+    put<uint32_t>(out, static_cast<uint32_t>(body.size()));
+    put<uint32_t>(out, static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(body.data()), body.size())));
+    out->append(body);
+}
+
+static int64_t expiryMsOf(const Session& session)
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        session.getExpiryTime().time_since_epoch()).count();
+}
+
+// 返回记录中的过期时间
+static int64_t appendSaveRecord(std::string* out, const Session& session)
+{
+    std::string body;
+    put<uint8_t>(&body, kSaveRecord);
+    put<uint16_t>(&body, static_cast<uint16_t>(session.getId().size()));
+    body.append(session.getId());
+    int64_t expiryMs = expiryMsOf(session);
+    put<int64_t>(&body, expiryMs);
+    put<int32_t>(&body, session.getMaxAge());
+    auto data = session.getData();
+    put<uint32_t>(&body, static_cast<uint32_t>(data.size()));
+    for (const auto& item : data)
+    {
+        putString(&body, item.first);
+        putString(&body, item.second);
+    }
+    appendRecord(out, body);
+    return expiryMs;
+}
+
+static void appendRemoveRecord(std::string* out, const std::string& sessionId)
+{
+    std::string body;
+    put<uint8_t>(&body, kRemoveRecord);
+    put<uint16_t>(&body, static_cast<uint16_t>(sessionId.size()));
+    body.append(sessionId);
+    appendRecord(out, body);
+}
+
+// 带边界检查的顺序读取
+class RecordReader
+{
+public:
+    RecordReader(const char* data, size_t size)
+        : p_(data)
+        , end_(data + size)
+    {}
+
+    template <typename T>
+    bool get(T* value)
+    {
+        if (static_cast<size_t>(end_ - p_) < sizeof(T))
+        {
+            return false;
+        }
+        memcpy(value, p_, sizeof(T));
+        p_ += sizeof(T);
+        return true;
+    }
+
+    bool getBytes(size_t len, std::string* s)
+    {
+        if (static_cast<size_t>(end_ - p_) < len)
+        {
+            return false;
+        }
+        s->assign(p_, len);
+        p_ += len;
+        return true;
+    }
+
+    bool getString(std::string* s)
+    {
+        uint32_t len;
+        return get(&len) && getBytes(len, s);
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+PersistentSessionStorage::PersistentSessionStorage(const std::string& path,
+                                                   std::chrono::milliseconds flushInterval)
+    : path_(path)
+    , flushInterval_(flushInterval)
+{
+    if (open())
+    {
+        recover();
+        flushThread_ = std::thread(&PersistentSessionStorage::flushLoop, this);
+    }
+    else
+    {
+        LOG_ERROR << "Session log " << path_ << " unavailable, sessions will not survive restarts";
+    }
+}
+
+PersistentSessionStorage::~PersistentSessionStorage()
+{
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stopping_ = true;
+    }
+    stopCond_.notify_all();
+    if (flushThread_.joinable())
+    {
+        flushThread_.join();
+    }
+    writePending();
+    unmap();
+}
+
+void PersistentSessionStorage::save(std::shared_ptr<Session> session)
+{
+    memory_.save(session);
+    // 已登记且尚未写入的会话不必再登记，写日志时取会话的最新数据
+    if (session->markDirty())
+    {
+        const std::string& sessionId = session->getId();
+        enqueue(sessionId, std::move(session));
+    }
+}
+
+void PersistentSessionStorage::touch(const std::shared_ptr<Session>& session)
+{
+    int64_t slackMs = static_cast<int64_t>(session->getMaxAge()) * 1000 / 10;
+    if (expiryMsOf(*session) - session->persistedExpiry() > slackMs && session->markDirty())
+    {
+        enqueue(session->getId(), session);
+    }
+}
+
+std::shared_ptr<Session> PersistentSessionStorage::load(const std::string& sessionId)
+{
+    return memory_.load(sessionId);
+}
+
+void PersistentSessionStorage::remove(const std::string& sessionId)
+{
+    memory_.remove(sessionId);
+    enqueue(sessionId, nullptr);
+}
+
+void PersistentSessionStorage::enqueue(const std::string& sessionId, std::shared_ptr<Session> session)
+{
+    PendingShard& shard = pending_[std::hash<std::string>()(sessionId) & (kPendingShards - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.emplace_back(sessionId, std::move(session));
+}
+
+// 记下会话在日志中最新的保存记录，recordSize 为 0 表示会话已删除
+void PersistentSessionStorage::logged(const std::string& sessionId, size_t recordSize, int64_t expiryMs)
+{
+    auto it = logged_.find(sessionId);
+    if (it != logged_.end())
+    {
+        liveBytes_ -= it->second.size;
+        if (recordSize == 0)
+        {
+            logged_.erase(it);
+            return;
+        }
+        it->second = {recordSize, expiryMs};
+    }
+    else if (recordSize > 0)
+    {
+        logged_.emplace(sessionId, LoggedRecord{recordSize, expiryMs});
+    }
+    liveBytes_ += recordSize;
+}
+
+void PersistentSessionStorage::cleanExpiredSession()
+{
+    // 过期会话不写删除记录，重建时跳过过期的记录，重写日志时丢弃
+    memory_.cleanExpiredSession();
+}
+
+void PersistentSessionStorage::flush()
+{
+    writePending();
+}
+
+bool PersistentSessionStorage::open()
+{
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0)
+    {
+        LOG_ERROR << "open " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0)
+    {
+        return false;
+    }
+
+    bool fresh = static_cast<size_t>(st.st_size) < kHeaderSize;
+    capacity_ = fresh ? kInitialCapacity : static_cast<size_t>(st.st_size);
+    if (fresh && ::ftruncate(fd_, capacity_) != 0)
+    {
+        LOG_ERROR << "ftruncate " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+    void* addr = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED)
+    {
+        LOG_ERROR << "mmap " << path_ << " failed: " << strerror(errno);
+        data_ = nullptr;
+        return false;
+    }
+    data_ = static_cast<char*>(addr);
+
+    if (!fresh && memcmp(data_, kMagic, kHeaderSize) != 0)
+    {
+        LOG_WARN << "Session log " << path_ << " has unknown format, starting empty";
+        memset(data_, 0, capacity_);
+        fresh = true;
+    }
+    if (fresh)
+    {
+        memcpy(data_, kMagic, kHeaderSize);
+    }
+    size_ = kHeaderSize;
+    return true;
+}
+
+void PersistentSessionStorage::recover()
+{
+    struct Snapshot
+    {
+        int64_t                                      expiryMs;
+        int32_t                                      maxAge;
+        std::unordered_map<std::string, std::string> data;
+        size_t                                       recordSize;
+    };
+    std::unordered_map<std::string, Snapshot> snapshots;
+
+    size_t offset = kHeaderSize;
+    bool corrupt = false;
+    while (offset + kRecordHeaderSize <= capacity_)
+    {
+        uint32_t length, crc;
+        memcpy(&length, data_ + offset, sizeof length);
+        memcpy(&crc, data_ + offset + 4, sizeof crc);
+        if (length == 0)
+        {
+            break; // 日志结束
+        }
+        const char* body = data_ + offset + kRecordHeaderSize;
+        if (length > capacity_ - offset - kRecordHeaderSize
+            || crc32(0, reinterpret_cast<const Bytef*>(body), length) != crc)
+        {
+            corrupt = true; // 写到一半时进程退出留下的残缺记录
+            break;
+        }
+
+        RecordReader reader(body, length);
+        uint8_t type = 0;
+        uint16_t idLength = 0;
+        std::string sessionId;
+        bool ok = reader.get(&type) && reader.get(&idLength) && reader.getBytes(idLength, &sessionId);
+        if (ok && type == kSaveRecord)
+        {
+            Snapshot snapshot;
+            uint32_t count = 0;
+            ok = reader.get(&snapshot.expiryMs) && reader.get(&snapshot.maxAge) && reader.get(&count);
+            for (uint32_t i = 0; ok && i < count; ++i)
+            {
+                std::string key, value;
+                ok = reader.getString(&key) && reader.getString(&value);
+                snapshot.data.emplace(std::move(key), std::move(value));
+            }
+            snapshot.recordSize = kRecordHeaderSize + length;
+            if (ok)
+            {
+                snapshots[sessionId] = std::move(snapshot);
+            }
+        }
+        else if (ok && type == kRemoveRecord)
+        {
+            snapshots.erase(sessionId);
+        }
+        if (!ok)
+        {
+            corrupt = true;
+            break;
+        }
+        offset += kRecordHeaderSize + length;
+    }
+    size_ = offset;
+    if (corrupt)
+    {
+        LOG_WARN << "Session log " << path_ << " truncated at offset " << offset;
+        memset(data_ + offset, 0, capacity_ - offset);
+    }
+
+    int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now().time_since_epoch()).count();
+    size_t restored = 0;
+    liveBytes_ = kHeaderSize;
+    logged_.clear();
+    for (auto& entry : snapshots)
+    {
+        Snapshot& snapshot = entry.second;
+        if (snapshot.expiryMs <= nowMs)
+        {
+            continue;
+        }
+        auto session = std::make_shared<Session>(entry.first, nullptr, snapshot.maxAge);
+        session->restore(std::move(snapshot.data),
+                         Clock::time_point(std::chrono::milliseconds(snapshot.expiryMs)));
+        session->setPersistedExpiry(snapshot.expiryMs);
+        memory_.save(session);
+        logged(entry.first, snapshot.recordSize, snapshot.expiryMs);
+        ++restored;
+    }
+    LOG_INFO << "Session log " << path_ << ": " << restored << " sessions restored from "
+             << size_ << " bytes";
+}
+
+void PersistentSessionStorage::flushLoop()
+{
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stopping_)
+    {
+        stopCond_.wait_for(lock, flushInterval_);
+        if (stopping_)
+        {
+            break;
+        }
+        lock.unlock();
+        writePending();
+        lock.lock();
+    }
+}
+
+void PersistentSessionStorage::writePending()
+{
+    std::vector<std::pair<std::string, std::shared_ptr<Session>>> pending;
+    for (PendingShard& shard : pending_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (pending.empty())
+        {
+            pending.swap(shard.entries);
+        }
+        else
+        {
+            std::move(shard.entries.begin(), shard.entries.end(), std::back_inserter(pending));
+            shard.entries.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (!data_)
+    {
+        return;
+    }
+    if (!pending.empty())
+    {
+        // 同一批修改序列化后一次追加，同一会话的记录保持登记顺序
+        std::string records;
+        for (const auto& entry : pending)
+        {
+            size_t begin = records.size();
+            if (entry.second)
+            {
+                // 先清除标记再读取数据，读取期间的修改会重新登记
+                entry.second->clearDirty();
+                int64_t expiryMs = appendSaveRecord(&records, *entry.second);
+                entry.second->setPersistedExpiry(expiryMs);
+                logged(entry.first, records.size() - begin, expiryMs);
+            }
+            else
+            {
+                appendRemoveRecord(&records, entry.first);
+                logged(entry.first, 0, 0);
+            }
+        }
+        append(records);
+    }
+    if (size_ > kCompactMinSize)
+    {
+        if (size_ <= 2 * liveBytes_)
+        {
+            // 过期会话不写删除记录，日志较大时把它们的记录从有效数据中扣除后再判断是否需要重写
+            int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                Clock::now().time_since_epoch()).count();
+            for (auto it = logged_.begin(); it != logged_.end();)
+            {
+                if (it->second.expiryMs <= nowMs)
+                {
+                    liveBytes_ -= it->second.size;
+                    it = logged_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        if (size_ > 2 * liveBytes_)
+        {
+            compact();
+        }
+    }
+}
+
+void PersistentSessionStorage::append(const std::string& records)
+{
+    if (!reserve(records.size()))
+    {
+        LOG_ERROR << "Session log " << path_ << " full, " << records.size() << " bytes dropped";
+        return;
+    }
+    memcpy(data_ + size_, records.data(), records.size());
+    size_ += records.size();
+    ::msync(data_, capacity_, MS_ASYNC);
+}
+
+bool PersistentSessionStorage::reserve(size_t size)
+{
+    // 末尾至少保留一个全 0 的记录头作为结束标记
+    size_t required = size_ + size + kRecordHeaderSize;
+    if (required <= capacity_)
+    {
+        return true;
+    }
+    size_t capacity = capacity_;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+    if (::ftruncate(fd_, capacity) != 0)
+    {
+        LOG_ERROR << "ftruncate " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+    void* addr = ::mremap(data_, capacity_, capacity, MREMAP_MAYMOVE);
+    if (addr == MAP_FAILED)
+    {
+        LOG_ERROR << "mremap " << path_ << " failed: " << strerror(errno);
+        return false;
+    }
+    data_ = static_cast<char*>(addr);
+    capacity_ = capacity;
+    return true;
+}
+
+// 只保留仍然有效的会话，写入新文件后替换原日志
+void PersistentSessionStorage::compact()
+{
+    std::string records(kMagic, kHeaderSize);
+    std::unordered_map<std::string, LoggedRecord> latest;
+    memory_.forEachSession([&records, &latest](const std::shared_ptr<Session>& session) {
+        if (!session->isExpired())
+        {
+            size_t begin = records.size();
+            int64_t expiryMs = appendSaveRecord(&records, *session);
+            latest[session->getId()] = {records.size() - begin, expiryMs};
+        }
+    });
+
+    std::string tmpPath = path_ + ".compact";
+    int fd = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        LOG_ERROR << "open " << tmpPath << " failed: " << strerror(errno);
+        return;
+    }
+    size_t capacity = kInitialCapacity;
+    while (capacity < records.size() * 2)
+    {
+        capacity *= 2;
+    }
+    bool ok = ::write(fd, records.data(), records.size()) == static_cast<ssize_t>(records.size())
+        && ::ftruncate(fd, capacity) == 0
+        && ::fsync(fd) == 0;
+    void* addr = ok ? ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (addr == MAP_FAILED || ::rename(tmpPath.c_str(), path_.c_str()) != 0)
+    {
+        LOG_ERROR << "Compacting session log " << path_ << " failed: " << strerror(errno);
+        if (addr != MAP_FAILED)
+        {
+            ::munmap(addr, capacity);
+        }
+        ::close(fd);
+        ::unlink(tmpPath.c_str());
+        return;
+    }
+
+    LOG_INFO << "Session log " << path_ << " compacted from " << size_ << " to " << records.size() << " bytes";
+    unmap();
+    fd_ = fd;
+    data_ = static_cast<char*>(addr);
+    capacity_ = capacity;
+    size_ = records.size();
+    liveBytes_ = size_;
+    logged_.swap(latest);
+}
+
+void PersistentSessionStorage::unmap()
+{
+    if (data_)
+    {
+        ::msync(data_, capacity_, MS_SYNC);
+        ::munmap(data_, capacity_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace session
+} // namespace http
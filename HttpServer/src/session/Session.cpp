@@ -2,7 +2,6 @@
 
 #include "../include/session/SessionManager.h"
 #include <muduo/base/Logging.h>
-#include <iostream>
 
 namespace http
 {
@@ -20,23 +19,46 @@ Session::Session(const std::string& sessionId, SessionManager* sessionManager, i
 // 检查会话是否已过期
 bool Session::isExpired() const
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     return std::chrono::system_clock::now() > expiryTime_;
 }
 
+std::chrono::system_clock::time_point Session::getExpiryTime() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return expiryTime_;
+}
+
 // 刷新会话的过期时间
 void Session::refresh()
 {
-    expiryTime_ = std::chrono::system_clock::now() + std::chrono::seconds(maxAge_);
-    std::cout << "Session " << sessionId_ << " refreshed, new expiry time: " << std::chrono::system_clock::to_time_t(expiryTime_) << std::endl;
+    auto expiryTime = std::chrono::system_clock::now() + std::chrono::seconds(maxAge_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        expiryTime_ = expiryTime;
+    }
+    LOG_DEBUG << "Session " << sessionId_ << " refreshed, new expiry time: " << std::chrono::system_clock::to_time_t(expiryTime);
 
 }
 
 // 设置会话数据
 void Session::setValue(const std::string& key, const std::string& value)
 {
-    data_[key] = value;
-    // 如果设置了manager，自动保存更改
-    if (sessionManager_)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_[key] = value;
+    }
+    notifyChanged();
+}
+
+// 如果设置了manager，自动保存更改；内存存储中已保存的会话不会再进入索引
+void Session::notifyChanged()
+{
+    if (changeCallback_)
+    {
+        changeCallback_(*this);
+    }
+    else if (sessionManager_)
     {
         sessionManager_->updateSession(shared_from_this());
     }
@@ -45,20 +67,43 @@ void Session::setValue(const std::string& key, const std::string& value)
 // 获取会话数据
 std::string Session::getValue(const std::string& key) const
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto it = data_.find(key);
     return it != data_.end() ? it->second : std::string();
 }
 
+std::unordered_map<std::string, std::string> Session::getData() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_;
+}
+
+void Session::restore(std::unordered_map<std::string, std::string> data,
+                      std::chrono::system_clock::time_point expiryTime)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_ = std::move(data);
+    expiryTime_ = expiryTime;
+}
+
 // 删除会话数据
 void Session::remove(const std::string& key)
 {
-    data_.erase(key);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_.erase(key);
+    }
+    notifyChanged();
 }
 
 // 清空会话数据
 void Session::clear()
 {
-    data_.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        data_.clear();
+    }
+    notifyChanged();
 }
 
 } //namespace session
@@ -0,0 +1,270 @@
+#include "../../include/session/SessionCookieCodec.h"
+#include "../../include/utils/SecureRandom.h"
+#include <muduo/base/Logging.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <cstring>
+
+namespace http
+{
+namespace session
+{
+
+// cookie 的二进制格式：版本(1) | 标志(1) | 密钥标识(4) | [IV(16)] | 载荷 | HMAC(32)
+static const unsigned char kVersion = 1;
+static const unsigned char kFlagEncrypted = 0x01;
+static const size_t kHeaderSize = 6;
+static const size_t kIvSize = 16;
+static const size_t kMacSize = 32;
+
+static const char kBase64Url[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// base64url 编码，不加填充
+static std::string base64UrlEncode(const unsigned char* data, size_t len)
+{
+    std::string out;
+    out.reserve((len * 4 + 2) / 3);
+    size_t i = 0;
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out.push_back(kBase64Url[(n >> 18) & 63]);
+        out.push_back(kBase64Url[(n >> 12) & 63]);
+        out.push_back(kBase64Url[(n >> 6) & 63]);
+        out.push_back(kBase64Url[n & 63]);
+    }
+    if (i < len)
+    {
+        uint32_t n = data[i] << 16;
+        if (i + 1 < len)
+        {
+            n |= data[i + 1] << 8;
+        }
+        out.push_back(kBase64Url[(n >> 18) & 63]);
+        out.push_back(kBase64Url[(n >> 12) & 63]);
+        if (i + 1 < len)
+        {
+            out.push_back(kBase64Url[(n >> 6) & 63]);
+        }
+    }
+    return out;
+}
+
+static int base64UrlValue(char c)
+{
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '-') return 62;
+    if (c == '_') return 63;
+    return -1;
+}
+
+static bool base64UrlDecode(std::string_view in, std::string* out)
+{
+    if (in.size() % 4 == 1)
+    {
+        return false;
+    }
+    out->clear();
+    out->reserve(in.size() * 3 / 4);
+    uint32_t n = 0;
+    int bits = 0;
+    for (char c : in)
+    {
+        int v = base64UrlValue(c);
+        if (v < 0)
+        {
+            return false;
+        }
+        n = (n << 6) | static_cast<uint32_t>(v);
+        bits += 6;
+        if (bits >= 8)
+        {
+            bits -= 8;
+            out->push_back(static_cast<char>((n >> bits) & 0xff));
+        }
+    }
+    return true;
+}
+
+// AES-256-CTR，加密与解密是同一操作
+static bool aesCtr(const unsigned char* key, const unsigned char* iv,
+                   const unsigned char* in, size_t len, unsigned char* out)
+{
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx)
+    {
+        return false;
+    }
+    int outLen = 0;
+    bool ok = EVP_EncryptInit_ex(ctx, EVP_aes_256_ctr(), nullptr, key, iv) == 1
+        && EVP_EncryptUpdate(ctx, out, &outLen, in, static_cast<int>(len)) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+SessionCookieCodec::KeyRing::~KeyRing()
+{
+    for (auto& key : keys)
+    {
+        OPENSSL_cleanse(&key, sizeof(key));
+    }
+}
+
+SessionCookieCodec::SessionCookieCodec(const std::vector<std::string>& secrets, bool encrypt,
+                                       size_t maxRetiredKeys)
+    : encrypt_(encrypt)
+    , maxRetiredKeys_(maxRetiredKeys)
+{
+    auto ring = std::make_shared<KeyRing>();
+    for (const auto& secret : secrets)
+    {
+        ring->keys.push_back(derive(secret));
+    }
+    if (ring->keys.empty())
+    {
+        // 没有配置密钥时随机生成（仅本进程可用）
+        std::string secret(32, '\0');
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(&secret[0]), 32) != 1)
+        {
+            LOG_FATAL << "Failed to generate session cookie secret";
+        }
+        ring->keys.push_back(derive(secret));
+        OPENSSL_cleanse(&secret[0], secret.size());
+    }
+    keys_ = std::move(ring);
+}
+
+void SessionCookieCodec::rotate(const std::string& secret)
+{
+    std::shared_ptr<const KeyRing> old = std::atomic_load(&keys_);
+    auto ring = std::make_shared<KeyRing>();
+    ring->keys.push_back(derive(secret));
+    for (size_t i = 0; i < old->keys.size() && i < maxRetiredKeys_; ++i)
+    {
+        ring->keys.push_back(old->keys[i]);
+    }
+    std::atomic_store(&keys_, std::shared_ptr<const KeyRing>(std::move(ring)));
+    LOG_INFO << "Session cookie key rotated";
+}
+
+std::string SessionCookieCodec::encode(std::string_view payload) const
+{
+    std::shared_ptr<const KeyRing> ring = std::atomic_load(&keys_);
+    const Key& key = ring->keys.front();
+
+    size_t bodyOffset = kHeaderSize + (encrypt_ ? kIvSize : 0);
+    std::string blob(bodyOffset + payload.size() + kMacSize, '\0');
+    unsigned char* p = reinterpret_cast<unsigned char*>(&blob[0]);
+    p[0] = kVersion;
+    p[1] = encrypt_ ? kFlagEncrypted : 0;
+    memcpy(p + 2, key.id, sizeof(key.id));
+    if (encrypt_)
+    {
+        unsigned char* iv = p + kHeaderSize;
+        secureRandomBytes(iv, kIvSize);
+        if (!aesCtr(key.encKey, iv, reinterpret_cast<const unsigned char*>(payload.data()),
+                       payload.size(), p + bodyOffset))
+        {
+            LOG_ERROR << "Failed to encrypt session cookie";
+            return std::string();
+        }
+    }
+    else
+    {
+        memcpy(p + bodyOffset, payload.data(), payload.size());
+    }
+
+    size_t signedSize = bodyOffset + payload.size();
+    unsigned int macLen = 0;
+    HMAC(EVP_sha256(), key.macKey, sizeof(key.macKey), p, signedSize, p + signedSize, &macLen);
+    return base64UrlEncode(p, blob.size());
+}
+
+bool SessionCookieCodec::decode(std::string_view token, std::string* payload, bool* isCurrent) const
+{
+    std::string blob;
+    if (!base64UrlDecode(token, &blob) || blob.size() < kHeaderSize + kMacSize)
+    {
+        return false;
+    }
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(blob.data());
+    bool encrypted = (p[1] & kFlagEncrypted) != 0;
+    size_t bodyOffset = kHeaderSize + (encrypted ? kIvSize : 0);
+    if (p[0] != kVersion || blob.size() < bodyOffset + kMacSize)
+    {
+        return false;
+    }
+
+    std::shared_ptr<const KeyRing> ring = std::atomic_load(&keys_);
+    const Key* key = nullptr;
+    size_t index = 0;
+    for (; index < ring->keys.size(); ++index)
+    {
+        if (memcmp(ring->keys[index].id, p + 2, sizeof(Key::id)) == 0)
+        {
+            key = &ring->keys[index];
+            break;
+        }
+    }
+    if (!key)
+    {
+        return false;
+    }
+
+    size_t signedSize = blob.size() - kMacSize;
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int macLen = 0;
+    HMAC(EVP_sha256(), key->macKey, sizeof(key->macKey), p, signedSize, mac, &macLen);
+    if (macLen != kMacSize || CRYPTO_memcmp(mac, p + signedSize, kMacSize) != 0)
+    {
+        return false;
+    }
+
+    size_t bodySize = signedSize - bodyOffset;
+    payload->resize(bodySize);
+    if (encrypted)
+    {
+        if (!aesCtr(key->encKey, p + kHeaderSize, p + bodyOffset, bodySize,
+                    reinterpret_cast<unsigned char*>(&(*payload)[0])))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        payload->assign(blob, bodyOffset, bodySize);
+    }
+    if (isCurrent)
+    {
+        // 只接受加密 cookie 的配置下，明文 cookie 同样需要重新签发
+        *isCurrent = index == 0 && encrypted == encrypt_;
+    }
+    return true;
+}
+
+// 每个字段分别派生：HMAC-SHA256(secret, label)
+SessionCookieCodec::Key SessionCookieCodec::derive(const std::string& secret)
+{
+    Key key;
+    auto expand = [&secret](const char* label, unsigned char* out, size_t len) {
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLen = 0;
+        HMAC(EVP_sha256(), secret.data(), static_cast<int>(secret.size()),
+             reinterpret_cast<const unsigned char*>(label), strlen(label), digest, &digestLen);
+        memcpy(out, digest, len);
+        OPENSSL_cleanse(digest, sizeof(digest));
+    };
+    expand("cookie id", key.id, sizeof(key.id));
+    expand("cookie hmac", key.macKey, sizeof(key.macKey));
+    expand("cookie aes", key.encKey, sizeof(key.encKey));
+    return key;
+}
+
+} // namespace session
+} // namespace http
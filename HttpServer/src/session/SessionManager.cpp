@@ -1,24 +1,151 @@
 #include"../include/session/SessionManager.h"
-#include <iomanip>
-#include <iostream>
-#include <sstream>
+#include "../include/http/ResponseWriter.h"
+#include "../include/utils/SecureRandom.h"
 #include <muduo/base/Logging.h>
 namespace http
 {
 namespace session
 {
 
-// 初始化会话管理器，设置会话存储对象和随机数生成器
+// 签名 cookie 模式下会话 cookie 的名字
+static const char kSignedCookieName[] = "session";
+// 浏览器对单个 cookie 的长度限制
+static const size_t kMaxCookieSize = 4096;
+
+// 在 Cookie 头中按名字查找值
+static std::string_view findCookie(std::string_view cookies, std::string_view name)
+{
+    size_t pos = 0;
+    while (pos < cookies.size())
+    {
+        size_t end = cookies.find(';', pos);
+        if (end == std::string_view::npos)
+        {
+            end = cookies.size();
+        }
+        std::string_view item = cookies.substr(pos, end - pos);
+        while (!item.empty() && item.front() == ' ')
+        {
+            item.remove_prefix(1);
+        }
+        if (item.size() > name.size() && item.compare(0, name.size(), name) == 0
+            && item[name.size()] == '=')
+        {
+            return item.substr(name.size() + 1);
+        }
+        pos = end + 1;
+    }
+    return std::string_view();
+}
+
+// 签名 cookie 的载荷：过期时间(8) | id | 数据项个数(2) | (键 | 值)*，字符串以 2 字节长度开头
+static void appendUint(std::string& out, uint64_t value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; --i)
+    {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+static void appendString(std::string& out, const std::string& value)
+{
+    appendUint(out, value.size(), 2);
+    out.append(value);
+}
+
+static bool readUint(std::string_view& in, int bytes, uint64_t* value)
+{
+    if (in.size() < static_cast<size_t>(bytes))
+    {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < bytes; ++i)
+    {
+        *value = (*value << 8) | static_cast<unsigned char>(in[i]);
+    }
+    in.remove_prefix(bytes);
+    return true;
+}
+
+static bool readString(std::string_view& in, std::string* value)
+{
+    uint64_t len = 0;
+    if (!readUint(in, 2, &len) || in.size() < len)
+    {
+        return false;
+    }
+    value->assign(in.data(), len);
+    in.remove_prefix(len);
+    return true;
+}
+
+static std::string encodePayload(const Session& session)
+{
+    auto data = session.getData();
+    auto expiry = std::chrono::duration_cast<std::chrono::seconds>(
+        session.getExpiryTime().time_since_epoch()).count();
+    std::string out;
+    appendUint(out, static_cast<uint64_t>(expiry), 8);
+    appendString(out, session.getId());
+    appendUint(out, data.size(), 2);
+    for (const auto& item : data)
+    {
+        appendString(out, item.first);
+        appendString(out, item.second);
+    }
+    return out;
+}
+
+// 解出会话，格式错误或已过期返回 nullptr
+static std::shared_ptr<Session> decodePayload(std::string_view in, SessionManager* manager)
+{
+    uint64_t expiry = 0;
+    uint64_t count = 0;
+    std::string id;
+    if (!readUint(in, 8, &expiry) || !readString(in, &id) || !readUint(in, 2, &count))
+    {
+        return nullptr;
+    }
+    auto expiryTime = std::chrono::system_clock::time_point(std::chrono::seconds(expiry));
+    if (std::chrono::system_clock::now() > expiryTime)
+    {
+        return nullptr;
+    }
+    std::unordered_map<std::string, std::string> data;
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        std::string key;
+        std::string value;
+        if (!readString(in, &key) || !readString(in, &value))
+        {
+            return nullptr;
+        }
+        data[std::move(key)] = std::move(value);
+    }
+    auto session = std::make_shared<Session>(id, manager);
+    session->restore(std::move(data), expiryTime);
+    return session;
+}
+
+// 初始化会话管理器，设置会话存储对象
 SessionManager::SessionManager(std::unique_ptr<SessionStorage> storage)
     : storage_(std::move(storage)) 
-    , rng_(std::random_device{}()) // 初始化随机数生成器，用于生成随机的会话ID
+{}
+
+SessionManager::SessionManager(std::shared_ptr<SessionCookieCodec> codec)
+    : codec_(std::move(codec))
 {}
 
 // 从请求中获取或创建会话，也就是说，如果请求中包含会话ID，则从存储中加载会话，否则创建一个新的会话
 std::shared_ptr<Session> SessionManager::getSession(const HttpRequest& req, HttpResponse* resp)
 {   
-    cleanExpiredSessions();
-    
+    if (codec_)
+    {
+        return getCookieSession(req, resp);
+    }
+
+    // 过期会话由服务器的定时器统一清理，这里只在加载时检查本会话
     std::string sessionId = getSessionIdFromCookie(req);
     
     std::shared_ptr<Session> session;
@@ -28,64 +155,150 @@ std::shared_ptr<Session> SessionManager::getSession(const HttpRequest& req, Http
         session = storage_->load(sessionId);
     }
 
-    if (!session || session->isExpired()){
+    bool isNew = !session || session->isExpired();
+    if (isNew){
         sessionId = generateSessionId();
         session = std::make_shared<Session>(sessionId, this);
         setSessionCookie(sessionId, resp);
-        std::cout << "New session " << sessionId << " created."<< std::endl;
+        LOG_DEBUG << "New session " << sessionId << " created";
 
         storage_->save(session); 
     }else {
         session->setManager(this); // 为现有会话设置管理器
-        std::cout << "Existed session " << sessionId << " reused." << std::endl;
+        LOG_DEBUG << "Existed session " << sessionId << " reused";
     } 
 
     session->refresh();
+    if (!isNew)
+    {
+        // 让持久化存储记下新的过期时间，只在推后足够多时才写日志
+        storage_->touch(session);
+    }
    
     return session;
 }
 
-// 生成唯一的会话标识符，确保会话的唯一性和安全性
-std::string SessionManager::generateSessionId()
+// 签名 cookie 模式：校验 cookie 并从中恢复会话，不访问任何共享状态
+std::shared_ptr<Session> SessionManager::getCookieSession(const HttpRequest& req, HttpResponse* resp)
 {
-    std::lock_guard<std::mutex> lock(rng_mutex_);
-    std::stringstream ss;
-    std::uniform_int_distribution<> dist(0, 15);
+    std::shared_ptr<Session> session;
+    bool isCurrent = false;
+    std::string payload;
+    std::string_view token = findCookie(req.getHeader(HttpRequest::kCookie), kSignedCookieName);
+    if (!token.empty() && codec_->decode(token, &payload, &isCurrent))
+    {
+        session = decodePayload(payload, this);
+    }
 
-    // 生成32个字符的会话ID，每个字符是一个十六进制数字
-    for (int i = 0; i < 32; ++i)
+    if (!session)
     {
-        ss << std::hex << dist(rng_);
+        // 新会话在写入数据之前不签发 cookie
+        session = std::make_shared<Session>(generateSessionId(), this);
+    }
+    else
+    {
+        // 剩余有效期不足一半或由旧密钥签发时才重新签发，避免每个响应都带上 Set-Cookie
+        auto remaining = session->getExpiryTime() - std::chrono::system_clock::now();
+        if (!isCurrent || remaining < std::chrono::seconds(session->getMaxAge() / 2))
+        {
+            session->refresh();
+            setSignedCookie(*session, resp);
+        }
     }
 
-    std::cout << "Generated session ID: " << ss.str()<< " Success." << std::endl;
-    return ss.str();
+    // 处理函数修改会话数据时重新签发 cookie
+    // defer() 之后原响应对象会被销毁，改为写入 ResponseWriter 持有的响应；
+    // 响应写出后不再持有任何响应，之后的修改（如保留了会话对象）丢弃
+    auto target = std::make_shared<CookieTarget>();
+    target->response = resp;
+    resp->addDeferListener([target](const std::shared_ptr<ResponseWriter>& writer) {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        target->response = nullptr;
+        target->writer = writer;
+    });
+    resp->addWrittenListener([target] {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        target->response = nullptr;
+        target->writer.reset();
+    });
+    session->setChangeCallback([this, target](Session& changed) {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        if (target->response)
+        {
+            setSignedCookie(changed, target->response);
+            return;
+        }
+        std::shared_ptr<ResponseWriter> writer = target->writer.lock();
+        if (writer && !writer->isDone())
+        {
+            setSignedCookie(changed, writer->response());
+        }
+        else
+        {
+            LOG_WARN << "Session " << changed.getId() << " changed after its response completed";
+        }
+    });
+    return session;
+}
+
+void SessionManager::setSignedCookie(Session& session, HttpResponse* resp)
+{
+    std::string cookie = kSignedCookieName;
+    if (session.getData().empty())
+    {
+        // 会话被清空（如注销）时让客户端删除 cookie
+        cookie += "=; Path=/; Max-Age=0; HttpOnly";
+    }
+    else
+    {
+        cookie += "=" + codec_->encode(encodePayload(session)) + "; Path=/; HttpOnly";
+        if (cookie.size() > kMaxCookieSize)
+        {
+            LOG_ERROR << "Session cookie too large: " << cookie.size() << " bytes";
+        }
+    }
+    resp->addHeader("Set-Cookie", cookie);
 }
 
+// 生成唯一的会话标识符：128 位密码学安全随机数的十六进制表示，不可预测，线程之间不加锁
+std::string SessionManager::generateSessionId()
+{
+    char id[32];
+    secureRandomHex(id, sizeof id / 2);
+    return std::string(id, sizeof id);
+}
+
+// 签名 cookie 模式下服务端没有会话可删除
 void SessionManager::destroySession(const std::string& sessionId)
 {
-    storage_->remove(sessionId);
+    if (storage_)
+    {
+        storage_->remove(sessionId);
+    }
 }
 
 void SessionManager::cleanExpiredSessions()
 {
     // 清理过期的会话,内存存储实现
-     storage_->cleanExpiredSession();
+    if (storage_)
+    {
+        storage_->cleanExpiredSession();
+    }
 }
 
 std::string SessionManager::getSessionIdFromCookie(const HttpRequest& req)
 {
     std::string sessionId;
-    std::string cookie = req.getHeader("Cookie");
+    std::string_view cookie = req.getHeader(HttpRequest::kCookie);
 
     if (!cookie.empty())
     {
         size_t pos = cookie.find("sessionId=");
-        if (pos != std::string::npos)
+        if (pos != std::string_view::npos)
         {
             pos += 10; // 跳过"sessionId="
             size_t end = cookie.find(';', pos);
-            if (end != std::string::npos)
+            if (end != std::string_view::npos)
             {
                 sessionId = cookie.substr(pos, end - pos);
             }
@@ -104,7 +317,7 @@ void SessionManager::setSessionCookie(const std::string& sessionId, HttpResponse
     // 设置会话ID到响应头中，作为Cookie
     std::string cookie = "sessionId=" + sessionId + "; Path=/; HttpOnly";
     resp->addHeader("Set-Cookie", cookie);
-    std::cout << "Set session cookie: " << cookie <<" Success."<< std::endl;
+    LOG_DEBUG << "Set session cookie: " << cookie;
 }
 
 } // namespace session
@@ -1,5 +1,4 @@
 #include "../include/session/SessionStorage.h"
-#include <iostream>
 #include <muduo/base/Logging.h>
 namespace http
 {
@@ -9,62 +8,120 @@ namespace session
 
 void MemorySessionStorage::save(std::shared_ptr<Session> session)
 {
-    // 创建会话副本并存储
-    std::lock_guard<std::mutex> lock(mutex_);
-    sessions_[session->getId()] = session;
-    std::cout << "Session " << session->getId() << " saved to memory storage Success." << std::endl;
+    Shard& shard = shardOf(session->getId());
+    {
+        // 已保存的同一个会话对象（如 setValue 之后的更新）只需确认存在
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(session->getId());
+        if (it != shard.sessions.end() && it->second == session)
+        {
+            return;
+        }
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto result = shard.sessions.insert_or_assign(session->getId(), session);
+        // 新会话才入堆，已有会话的过期时间在出堆时重新读取
+        if (result.second)
+        {
+            shard.expiryHeap.emplace(session->getExpiryTime(), session->getId());
+        }
+    }
+    LOG_DEBUG << "Session " << session->getId() << " saved to memory storage";
 }
 
 // 通过会话ID从存储中加载会话
 std::shared_ptr<Session> MemorySessionStorage::load(const std::string& sessionId)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(sessionId);
-    if (it != sessions_.end())
+    Shard& shard = shardOf(sessionId);
+    std::shared_ptr<Session> session;
     {
-        if (!it->second->isExpired())
-        {
-            std::cout << "Session " << sessionId << " loaded from memory storage Success" << std::endl;
-            return it->second;
-        }
-        else
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        if (it != shard.sessions.end())
         {
-            // 如果会话已过期，则从存储中移除
-            std::cout << "Session " << sessionId << " expired, loaded from memory storage Failed" << std::endl;
-            sessions_.erase(it);
+            session = it->second;
         }
-    }else{
-        std::cout << "Session " << sessionId << " don`t exited, loaded from memory storage Failed" << std::endl;
     }
-
-    // 如果会话不存在或已过期，则返回nullptr
-    return nullptr;
+    // 日志在锁外输出，不让各 IO 线程在分片锁内排队写日志
+    if (!session)
+    {
+        LOG_DEBUG << "Session " << sessionId << " not found in memory storage";
+        return nullptr;
+    }
+    // 已过期的会话视为不存在，由定时清理从存储中移除
+    if (session->isExpired())
+    {
+        LOG_DEBUG << "Session " << sessionId << " expired in memory storage";
+        return nullptr;
+    }
+    LOG_DEBUG << "Session " << sessionId << " loaded from memory storage";
+    return session;
 }
 
 // 通过会话ID从存储中移除会话
 void MemorySessionStorage::remove(const std::string& sessionId)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    sessions_.erase(sessionId);
+    Shard& shard = shardOf(sessionId);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.sessions.erase(sessionId);
 }
 
-void MemorySessionStorage::cleanExpiredSession()
+void MemorySessionStorage::forEachSession(const std::function<void (const std::shared_ptr<Session>&)>& f) const
 {
-
-    for (auto it = sessions_.begin(); it != sessions_.end();)
+    std::vector<std::shared_ptr<Session>> sessions;
+    for (const Shard& shard : shards_)
     {
-        
-        if (it->second->isExpired())
+        sessions.clear();
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            it = sessions_.erase(it);
-            std::cout << "clean expired session: " << it->second->getId() << std::endl;
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            sessions.reserve(shard.sessions.size());
+            for (const auto& entry : shard.sessions)
+            {
+                sessions.push_back(entry.second);
+            }
         }
-        else
+        for (const auto& session : sessions)
+        {
+            f(session);
+        }
+    }
+}
+
+void MemorySessionStorage::cleanExpiredSession()
+{
+    Clock::time_point now = Clock::now();
+    std::vector<std::shared_ptr<Session>> expired; // 在锁外释放
+    for (Shard& shard : shards_)
+    {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        // 只处理堆顶已到期的项，耗时与到期的会话数成正比，与会话总数无关
+        while (!shard.expiryHeap.empty() && shard.expiryHeap.top().first <= now)
         {
-            ++it;
+            std::string sessionId = shard.expiryHeap.top().second;
+            shard.expiryHeap.pop();
+            auto it = shard.sessions.find(sessionId);
+            if (it == shard.sessions.end())
+            {
+                continue; // 已被移除
+            }
+            if (it->second->isExpired())
+            {
+                expired.push_back(std::move(it->second));
+                shard.sessions.erase(it);
+            }
+            else
+            {
+                // 会话在此期间被刷新过，按新的过期时间重新入堆
+                shard.expiryHeap.emplace(it->second->getExpiryTime(), std::move(sessionId));
+            }
         }
     }
+    for (const auto& session : expired)
+    {
+        LOG_DEBUG << "clean expired session: " << session->getId();
+    }
 }
 
 } // namespace session
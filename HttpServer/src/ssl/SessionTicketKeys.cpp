@@ -0,0 +1,112 @@
+#include "../../include/ssl/SessionTicketKeys.h"
+#include <muduo/base/Logging.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+namespace ssl
+{
+
+SessionTicketKeys::SessionTicketKeys(const std::string& secret, int rotationSeconds, int lifetimeSeconds)
+    : secret_(secret)
+    , rotation_(rotationSeconds > 0 ? rotationSeconds : 3600)
+    , acceptedEpochs_((lifetimeSeconds + rotation_ - 1) / rotation_ + 1)
+{
+    if (secret_.empty())
+    {
+        secret_.resize(32);
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(&secret_[0]), 32) != 1)
+        {
+            LOG_FATAL << "Failed to generate session ticket secret";
+        }
+    }
+}
+
+SessionTicketKeys::~SessionTicketKeys()
+{
+    OPENSSL_cleanse(&secret_[0], secret_.size());
+    for (auto& key : keys_)
+    {
+        OPENSSL_cleanse(&key, sizeof(key));
+    }
+}
+
+SessionTicketKeys::Key SessionTicketKeys::current()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refreshLocked();
+    return keys_.front();
+}
+
+bool SessionTicketKeys::find(const unsigned char* name, Key* key, bool* isCurrent)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refreshLocked();
+    for (size_t i = 0; i < keys_.size(); ++i)
+    {
+        if (CRYPTO_memcmp(keys_[i].name, name, sizeof(keys_[i].name)) == 0)
+        {
+            *key = keys_[i];
+            *isCurrent = (i == 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 进入新的 epoch 时补上新密钥并淘汰过期的密钥
+void SessionTicketKeys::refreshLocked()
+{
+    int64_t epoch = static_cast<int64_t>(::time(nullptr)) / rotation_;
+    if (!keys_.empty() && keys_.front().epoch == epoch)
+    {
+        return;
+    }
+
+    int64_t oldest = epoch - acceptedEpochs_ + 1;
+    while (!keys_.empty() && keys_.back().epoch < oldest)
+    {
+        OPENSSL_cleanse(&keys_.back(), sizeof(Key));
+        keys_.pop_back();
+    }
+    int64_t next = keys_.empty() ? oldest : keys_.front().epoch + 1;
+    for (int64_t e = std::max(next, oldest); e <= epoch; ++e)
+    {
+        keys_.push_front(derive(e));
+    }
+    LOG_INFO << "Session ticket key rotated to epoch " << epoch;
+}
+
+// 每个字段分别派生：HMAC-SHA256(secret, label || epoch)
+SessionTicketKeys::Key SessionTicketKeys::derive(int64_t epoch) const
+{
+    Key key;
+    key.epoch = epoch;
+
+    auto expand = [this, epoch](const char* label, unsigned char* out, size_t len) {
+        unsigned char msg[32];
+        size_t labelLen = strlen(label);
+        memcpy(msg, label, labelLen);
+        for (int i = 0; i < 8; ++i)
+        {
+            msg[labelLen + i] = static_cast<unsigned char>(static_cast<uint64_t>(epoch) >> (56 - 8 * i));
+        }
+        unsigned char digest[EVP_MAX_MD_SIZE];
+        unsigned int digestLen = 0;
+        HMAC(EVP_sha256(), secret_.data(), static_cast<int>(secret_.size()),
+             msg, labelLen + 8, digest, &digestLen);
+        memcpy(out, digest, len);
+        OPENSSL_cleanse(digest, sizeof(digest));
+    };
+    expand("ticket name", key.name, sizeof(key.name));
+    expand("ticket aes", key.aesKey, sizeof(key.aesKey));
+    expand("ticket hmac", key.hmacKey, sizeof(key.hmacKey));
+    return key;
+}
+
+} // namespace ssl
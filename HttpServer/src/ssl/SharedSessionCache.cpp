@@ -0,0 +1,246 @@
+#include "../../include/ssl/SharedSessionCache.h"
+#include <muduo/base/Logging.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace ssl
+{
+
+static const uint32_t kCacheMagic = 0x53534c44; // 槽位改用 pthread 互斥锁后的布局
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "shared session cache requires address-free atomics");
+
+// 按缓存行对齐，紧随其后的槽位数组里的锁和 64 位字段也随之对齐
+struct alignas(64) SharedSessionCache::Header
+{
+    std::atomic<uint32_t> magic;
+    uint32_t              slotCount;
+    uint32_t              slotSize;
+};
+
+struct SharedSessionCache::Slot
+{
+    pthread_mutex_t lock; // 进程间共享的健壮锁，持锁进程退出后其他进程可以接手
+    uint32_t        idLength;
+    unsigned char   id[kMaxSessionIdLength];
+    int64_t         expire;
+    uint32_t        dataLength;
+    unsigned char   data[kMaxSessionLength];
+};
+
+namespace
+{
+
+// 槽位锁，只尝试一次，拿不到时视为未命中，不阻塞握手
+// 持锁进程崩溃时锁转给下一个加锁者（EOWNERDEAD），槽位可能写了一半，直接清空
+class SlotLock
+{
+public:
+    SlotLock(pthread_mutex_t* lock, uint32_t* idLength)
+        : lock_(lock)
+        , locked_(false)
+    {
+        int ret = pthread_mutex_trylock(lock_);
+        if (ret == EOWNERDEAD)
+        {
+            *idLength = 0;
+            ret = pthread_mutex_consistent(lock_);
+        }
+        locked_ = (ret == 0);
+    }
+
+    ~SlotLock()
+    {
+        if (locked_)
+        {
+            pthread_mutex_unlock(lock_);
+        }
+    }
+
+    bool locked() const { return locked_; }
+
+private:
+    pthread_mutex_t* lock_;
+    bool             locked_;
+};
+
+bool initSlotLock(pthread_mutex_t* lock)
+{
+    pthread_mutexattr_t attr;
+    bool ok = pthread_mutexattr_init(&attr) == 0
+        && pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0
+        && pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) == 0
+        && pthread_mutex_init(lock, &attr) == 0;
+    pthread_mutexattr_destroy(&attr);
+    return ok;
+}
+
+} // namespace
+
+SharedSessionCache::SharedSessionCache(const std::string& path, size_t slots)
+    : base_(nullptr)
+    , mapLength_(sizeof(Header) + slots * sizeof(Slot))
+    , slots_(nullptr)
+    , slotCount_(slots)
+{
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+    {
+        LOG_SYSERR << "Failed to open shared session cache " << path;
+        return;
+    }
+
+    // 初始化期间持有文件锁，其他进程在此等待；持锁进程中途崩溃时内核释放文件锁，
+    // 布局标记尚未写入，下一个进程重新初始化，不会一直停在初始化中
+    if (::flock(fd, LOCK_EX) != 0)
+    {
+        LOG_SYSERR << "Failed to lock shared session cache " << path;
+        ::close(fd);
+        return;
+    }
+
+    // 文件比映射短时访问末尾会 SIGBUS，取不到长度时不能映射
+    struct stat st;
+    if (::fstat(fd, &st) != 0
+        || (static_cast<size_t>(st.st_size) < mapLength_
+            && ::ftruncate(fd, static_cast<off_t>(mapLength_)) != 0))
+    {
+        LOG_SYSERR << "Failed to resize shared session cache " << path;
+        ::close(fd);
+        return;
+    }
+
+    void* addr = ::mmap(nullptr, mapLength_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        LOG_SYSERR << "Failed to map shared session cache " << path;
+        ::close(fd);
+        return;
+    }
+    base_ = addr;
+
+    // 没有布局标记（新文件或上次初始化未完成）时初始化各槽位的锁，最后写入标记
+    Header* header = static_cast<Header*>(base_);
+    Slot* slotBase = reinterpret_cast<Slot*>(static_cast<char*>(base_) + sizeof(Header));
+    bool ok = true;
+    if (header->magic.load(std::memory_order_acquire) != kCacheMagic)
+    {
+        header->slotCount = static_cast<uint32_t>(slotCount_);
+        header->slotSize = static_cast<uint32_t>(sizeof(Slot));
+        for (size_t i = 0; ok && i < slotCount_; ++i)
+        {
+            slotBase[i].idLength = 0;
+            ok = initSlotLock(&slotBase[i].lock);
+        }
+        if (ok)
+        {
+            header->magic.store(kCacheMagic, std::memory_order_release);
+        }
+        else
+        {
+            LOG_ERROR << "Failed to initialize shared session cache lock";
+        }
+    }
+    // 映射仍引用同一个打开的文件，关闭 fd 不会释放文件锁，须显式解锁
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+    if (!ok)
+    {
+        return;
+    }
+    if (header->slotCount != slotCount_ || header->slotSize != sizeof(Slot))
+    {
+        LOG_ERROR << "Shared session cache " << path << " has an incompatible layout";
+        return;
+    }
+    slots_ = slotBase;
+    LOG_INFO << "Shared session cache " << path << " with " << slotCount_ << " slots";
+}
+
+SharedSessionCache::~SharedSessionCache()
+{
+    if (base_)
+    {
+        ::munmap(base_, mapLength_);
+    }
+}
+
+// FNV-1a
+SharedSessionCache::Slot* SharedSessionCache::slotFor(const unsigned char* id, size_t idLen) const
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < idLen; ++i)
+    {
+        hash ^= id[i];
+        hash *= 1099511628211ULL;
+    }
+    return &slots_[hash % slotCount_];
+}
+
+bool SharedSessionCache::store(const unsigned char* id, size_t idLen,
+                               const unsigned char* data, size_t dataLen, int64_t expire)
+{
+    if (!slots_ || idLen == 0 || idLen > kMaxSessionIdLength || dataLen > kMaxSessionLength)
+    {
+        return false;
+    }
+    Slot* slot = slotFor(id, idLen);
+    SlotLock lock(&slot->lock, &slot->idLength);
+    if (!lock.locked())
+    {
+        return false;
+    }
+    slot->idLength = static_cast<uint32_t>(idLen);
+    memcpy(slot->id, id, idLen);
+    slot->expire = expire;
+    slot->dataLength = static_cast<uint32_t>(dataLen);
+    memcpy(slot->data, data, dataLen);
+    return true;
+}
+
+bool SharedSessionCache::lookup(const unsigned char* id, size_t idLen, std::string* data)
+{
+    if (!slots_ || idLen == 0 || idLen > kMaxSessionIdLength)
+    {
+        return false;
+    }
+    Slot* slot = slotFor(id, idLen);
+    SlotLock lock(&slot->lock, &slot->idLength);
+    if (!lock.locked()
+        || slot->idLength != idLen
+        || memcmp(slot->id, id, idLen) != 0
+        || slot->expire <= static_cast<int64_t>(::time(nullptr)))
+    {
+        return false;
+    }
+    data->assign(reinterpret_cast<const char*>(slot->data), slot->dataLength);
+    return true;
+}
+
+void SharedSessionCache::remove(const unsigned char* id, size_t idLen)
+{
+    if (!slots_ || idLen == 0 || idLen > kMaxSessionIdLength)
+    {
+        return;
+    }
+    Slot* slot = slotFor(id, idLen);
+    SlotLock lock(&slot->lock, &slot->idLength);
+    if (lock.locked() && slot->idLength == idLen && memcmp(slot->id, id, idLen) == 0)
+    {
+        slot->idLength = 0;
+        slot->dataLength = 0;
+    }
+}
+
+} // namespace ssl
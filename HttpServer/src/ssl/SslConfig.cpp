@@ -3,12 +3,17 @@
 namespace ssl
 {
 SslConfig::SslConfig()
-    : version_(SSLVersion::TLS_1_2)
+    : certReloadInterval_(0)
+    , version_(SSLVersion::TLS_1_2)
     , cipherList_("HIGH:!aNULL:!MDS")
     , verifyClient_(false)
     , verifyDepth_(4)
     , sessionTimeout_(300)
     , sessionCacheSize_(20480L)
+    , sessionTickets_(true)
+    , ticketKeyRotation_(3600)
+    , sharedCacheSlots_(4096)
+    , handshakeThreads_(0)
 {
 }
 
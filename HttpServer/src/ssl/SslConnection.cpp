@@ -1,28 +1,45 @@
 #include "../../include/ssl/SslConnection.h"
 #include <muduo/base/Logging.h>
+#include <muduo/net/EventLoop.h>
 #include <openssl/err.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 
 namespace ssl
 {
 
-// 自定义 BIO 方法
-static BIO_METHOD* createCustomBioMethod() 
+// 每次 SSL_read 预留的空间，一个 TLS 记录最多 16KB 明文
+static const size_t kReadChunk = 16 * 1024;
+
+// write() 按满记录的明文长度攒批加密
+static const size_t kRecordSize = 16 * 1024;
+
+// 自定义 BIO 方法：读直接取 TcpConnection 的输入缓冲区，写直接追加到待发送缓冲区
+static BIO_METHOD* createCustomBioMethod()
 {
-    BIO_METHOD* method = BIO_meth_new(BIO_TYPE_MEM, "custom");
+    BIO_METHOD* method = BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "muduo buffer");
     BIO_meth_set_write(method, SslConnection::bioWrite);
     BIO_meth_set_read(method, SslConnection::bioRead);
     BIO_meth_set_ctrl(method, SslConnection::bioCtrl);
     return method;
 }
 
+static BIO_METHOD* customBioMethod()
+{
+    static BIO_METHOD* method = createCustomBioMethod();
+    return method;
+}
+
 SslConnection::SslConnection(const TcpConnectionPtr& conn, SslContext* ctx)
     : ssl_(nullptr)
     , ctx_(ctx)
     , conn_(conn)
     , state_(SSLState::HANDSHAKE)
-    , readBio_(nullptr)
-    , writeBio_(nullptr)
+    , bio_(nullptr)
+    , input_(nullptr)
     , messageCallback_(nullptr)
+    , handshakeInFlight_(false)
 {
     // 创建 SSL 对象
     ssl_ = SSL_new(ctx_->getNativeHandle());
@@ -32,145 +49,299 @@ SslConnection::SslConnection(const TcpConnectionPtr& conn, SslContext* ctx)
     }
 
     // 创建 BIO
-    readBio_ = BIO_new(BIO_s_mem());
-    writeBio_ = BIO_new(BIO_s_mem());
-    
-    if (!readBio_ || !writeBio_) {
-        LOG_ERROR << "Failed to create BIO objects";
+    bio_ = BIO_new(customBioMethod());
+    if (!bio_) {
+        LOG_ERROR << "Failed to create BIO object";
         SSL_free(ssl_);
         ssl_ = nullptr;
         return;
     }
+    BIO_set_data(bio_, this);
+    BIO_set_init(bio_, 1);
 
-    SSL_set_bio(ssl_, readBio_, writeBio_);
+    SSL_set_bio(ssl_, bio_, bio_);  // 读写使用同一个 BIO，SSL 只持有一份引用
     SSL_set_accept_state(ssl_);  // 设置为服务器模式
-    
+
     // 设置 SSL 选项
     SSL_set_mode(ssl_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
     SSL_set_mode(ssl_, SSL_MODE_ENABLE_PARTIAL_WRITE);
-    
-    // 设置连接回调
-    conn_->setMessageCallback(
-        std::bind(&SslConnection::onRead, this, std::placeholders::_1,
-                 std::placeholders::_2, std::placeholders::_3));
+    // 连接空闲时释放 SSL 内部的读写缓冲区
+    SSL_set_mode(ssl_, SSL_MODE_RELEASE_BUFFERS);
 }
 
-SslConnection::~SslConnection() 
+SslConnection::~SslConnection()
 {
-    if (ssl_) 
+    if (ssl_)
     {
+        // 对端直接断开（未交换 close_notify）时 OpenSSL 会把会话从缓存中删除，
+        // 正常完成过握手的连接标记为已关闭，保留会话以便复用
+        if (state_ == SSLState::ESTABLISHED || state_ == SSLState::SHUTDOWN)
+        {
+            SSL_set_shutdown(ssl_, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+        }
         SSL_free(ssl_);  // 这会同时释放 BIO
     }
 }
 
-void SslConnection::startHandshake() 
+void SslConnection::startHandshake()
 {
+    if (!ssl_) {
+        conn_->shutdown();
+        return;
+    }
     SSL_set_accept_state(ssl_);
     handleHandshake();
 }
 
-void SslConnection::send(const void* data, size_t len) 
+void SslConnection::send(const void* data, size_t len)
+{
+    write(data, len);
+    flush();
+}
+
+void SslConnection::write(const void* data, size_t len)
 {
     if (state_ != SSLState::ESTABLISHED) {
         LOG_ERROR << "Cannot send data before SSL handshake is complete";
         return;
     }
-    
-    int written = SSL_write(ssl_, data, len);
-    if (written <= 0) {
-        int err = SSL_get_error(ssl_, written);
-        LOG_ERROR << "SSL_write failed: " << ERR_error_string(err, nullptr);
-        return;
+
+    const char* p = static_cast<const char*>(data);
+    // 先用本段补满上一段留下的不完整记录
+    if (pendingPlain_.readableBytes() > 0) {
+        size_t n = std::min(len, kRecordSize - pendingPlain_.readableBytes());
+        pendingPlain_.append(p, n);
+        p += n;
+        len -= n;
+        if (pendingPlain_.readableBytes() < kRecordSize) {
+            return;
+        }
+        bool ok = encrypt(pendingPlain_.peek(), pendingPlain_.readableBytes());
+        pendingPlain_.retrieveAll();
+        if (!ok) {
+            return;
+        }
+    }
+    // 整记录直接从原内存加密，不足一个记录的尾部留给下一段
+    size_t whole = len - len % kRecordSize;
+    if (encrypt(p, whole)) {
+        pendingPlain_.append(p + whole, len - whole);
+    }
+}
+
+void SslConnection::flush()
+{
+    if (state_ == SSLState::ESTABLISHED && pendingPlain_.readableBytes() > 0) {
+        encrypt(pendingPlain_.peek(), pendingPlain_.readableBytes());
     }
-    
-    char buf[4096];
-    int pending;
-    while ((pending = BIO_pending(writeBio_)) > 0) {
-        int bytes = BIO_read(writeBio_, buf, 
-                           std::min(pending, static_cast<int>(sizeof(buf))));
-        if (bytes > 0) {
-            conn_->send(buf, bytes);
+    pendingPlain_.retrieveAll();
+    flushEncrypted();
+}
+
+// 密文追加到 writeBuffer_，由 flushEncrypted 交给连接
+bool SslConnection::encrypt(const char* data, size_t len)
+{
+    // BIO 写入总是成功，SSL_write 每次最多写一个记录，循环直到全部加密
+    while (len > 0) {
+        int chunk = static_cast<int>(std::min(len, static_cast<size_t>(INT_MAX)));
+        int written = SSL_write(ssl_, data, chunk);
+        if (written <= 0) {
+            handleError(getLastError(written));
+            return false;
         }
+        data += written;
+        len -= written;
     }
+    return true;
 }
 
-void SslConnection::onRead(const TcpConnectionPtr& conn, BufferPtr buf, 
-                         muduo::Timestamp time) 
+void SslConnection::onRead(const TcpConnectionPtr& conn, BufferPtr buf,
+                         muduo::Timestamp time)
 {
+    if (!ssl_) {
+        buf->retrieveAll();
+        return;
+    }
+
+    if (state_ == SSLState::HANDSHAKE) {
+        if (!handshakeStart_.valid()) {
+            handshakeStart_ = time;
+        }
+        if (ctx_->asyncHandshake()) {
+            // 握手步骤执行期间 SSL 对象归握手线程，新数据留在 buf 中等它完成
+            if (!handshakeInFlight_) {
+                offloadHandshake(buf);
+            }
+            return;
+        }
+    }
+
+    input_ = buf;
     if (state_ == SSLState::HANDSHAKE) {
-        // 将数据写入 BIO
-        BIO_write(readBio_, buf->peek(), buf->readableBytes());
-        buf->retrieve(buf->readableBytes());
         handleHandshake();
-        return;
-    } else if (state_ == SSLState::ESTABLISHED) {
-        // 解密数据
-        char decryptedData[4096];
-        int ret = SSL_read(ssl_, decryptedData, sizeof(decryptedData));
+    }
+    // 握手完成的同一批数据中可能已经带有应用数据，继续解密
+    if (state_ == SSLState::ESTABLISHED) {
+        readDecrypted();
+    }
+    input_ = nullptr;
+
+    // 握手消息、会话票据、告警等由 SSL 内部产生的密文
+    flushEncrypted();
+
+    deliverDecrypted(time);
+}
+
+// 调用上层回调处理解密后的数据
+void SslConnection::deliverDecrypted(muduo::Timestamp time)
+{
+    if (messageCallback_ && decryptedBuffer_.readableBytes() > 0) {
+        messageCallback_(conn_, &decryptedBuffer_, time);
+    }
+}
+
+// 循环 SSL_read 直到输入中没有完整的记录，明文直接写入 decryptedBuffer_ 的可写区
+void SslConnection::readDecrypted()
+{
+    for (;;) {
+        decryptedBuffer_.ensureWritableBytes(kReadChunk);
+        int ret = SSL_read(ssl_, decryptedBuffer_.beginWrite(),
+                           static_cast<int>(decryptedBuffer_.writableBytes()));
         if (ret > 0) {
-            // 创建新的 Buffer 存储解密后的数据
-            muduo::net::Buffer decryptedBuffer;
-            decryptedBuffer.append(decryptedData, ret);
-            
-            // 调用上层回调处理解密后的数据
-            if (messageCallback_) {
-                messageCallback_(conn, &decryptedBuffer, time);
-            }
+            decryptedBuffer_.hasWritten(ret);
+            continue;
         }
+
+        int err = SSL_get_error(ssl_, ret);
+        if (err == SSL_ERROR_ZERO_RETURN) {
+            // 对端发送了 close_notify
+            state_ = SSLState::SHUTDOWN;
+            SSL_shutdown(ssl_);
+            flushEncrypted();  // 回应 close_notify，须在 shutdown 之前交给连接
+            conn_->shutdown();
+            return;
+        }
+        handleError(getLastError(ret));
+        return;
     }
 }
 
-void SslConnection::handleHandshake() 
+void SslConnection::handleHandshake()
 {
     int ret = SSL_do_handshake(ssl_);
-    
+    int err = ret == 1 ? SSL_ERROR_NONE : SSL_get_error(ssl_, ret);
+    bool pending = err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE;
+    finishHandshakeStep(ret, err, pending ? 0 : ERR_get_error());
+}
+
+// 把 buf 中的握手数据交给握手线程池执行 SSL_do_handshake（完整握手的私钥签名在这一步）
+void SslConnection::offloadHandshake(BufferPtr buf)
+{
+    if (buf->readableBytes() == 0) {
+        return;
+    }
+    // 握手消息很小，搬到本连接自己的缓冲区，连接的输入缓冲区始终只由 IO 线程访问
+    handshakeInput_.append(buf->peek(), buf->readableBytes());
+    buf->retrieveAll();
+    handshakeInFlight_ = true;
+
+    std::shared_ptr<SslConnection> self = shared_from_this();
+    ctx_->runHandshakeTask([self] {
+        self->input_ = &self->handshakeInput_;
+        int ret = SSL_do_handshake(self->ssl_);
+        self->input_ = nullptr;
+        // SSL_get_error 与错误码都依赖本线程的错误队列，须在工作线程中取出
+        int err = ret == 1 ? SSL_ERROR_NONE : SSL_get_error(self->ssl_, ret);
+        bool pending = err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE;
+        unsigned long errCode = pending ? 0 : ERR_get_error();
+        ERR_clear_error();
+        self->conn_->getLoop()->runInLoop([self, ret, err, errCode] {
+            self->onHandshakeOffloaded(ret, err, errCode);
+        });
+    });
+}
+
+// 握手步骤在握手线程池中执行完毕，回到 IO 线程继续
+void SslConnection::onHandshakeOffloaded(int ret, int err, unsigned long errCode)
+{
+    handshakeInFlight_ = false;
+    if (!conn_->connected()) {
+        return;  // 等待期间连接已断开
+    }
+
+    finishHandshakeStep(ret, err, errCode);
+    BufferPtr pending = conn_->inputBuffer();
+    if (state_ == SSLState::HANDSHAKE) {
+        offloadHandshake(pending);  // 等待期间到达了下一段握手数据
+        return;
+    }
+    if (state_ != SSLState::ESTABLISHED) {
+        return;
+    }
+
+    // 与最后一段握手消息一起到达的应用数据在 handshakeInput_ 中，等待期间到达的数据接在其后
+    handshakeInput_.append(pending->peek(), pending->readableBytes());
+    pending->retrieveAll();
+    input_ = &handshakeInput_;
+    readDecrypted();
+    input_ = nullptr;
+    // 不完整的记录放回连接的输入缓冲区（此时为空，顺序不变），之后走同步路径
+    pending->append(handshakeInput_.peek(), handshakeInput_.readableBytes());
+    handshakeInput_.retrieveAll();
+    handshakeInput_.shrink(0);
+
+    flushEncrypted();
+    deliverDecrypted(muduo::Timestamp::now());
+}
+
+// 处理一次 SSL_do_handshake 的结果，err/errCode 由调用 SSL_do_handshake 的线程取出
+void SslConnection::finishHandshakeStep(int ret, int err, unsigned long errCode)
+{
+    // 先发出本轮产生的握手消息（失败时为告警）
+    flushEncrypted();
+
     if (ret == 1) {
         state_ = SSLState::ESTABLISHED;
         LOG_INFO << "SSL handshake completed successfully";
         LOG_INFO << "Using cipher: " << SSL_get_cipher(ssl_);
         LOG_INFO << "Protocol version: " << SSL_get_version(ssl_);
-        
-        // 握手完成后，确保设置了正确的回调
-        if (!messageCallback_) {
-            LOG_WARN << "No message callback set after SSL handshake";
-        }
+        int64_t latencyUs = handshakeStart_.valid()
+            ? muduo::Timestamp::now().microSecondsSinceEpoch() - handshakeStart_.microSecondsSinceEpoch()
+            : 0;
+        ctx_->onHandshakeCompleted(SSL_session_reused(ssl_) == 1, latencyUs);
         return;
     }
-    
-    int err = SSL_get_error(ssl_, ret);
+
     switch (err) {
         case SSL_ERROR_WANT_READ:
         case SSL_ERROR_WANT_WRITE:
             // 正常的握手过程，需要继续
             break;
-            
+
         default: {
             // 获取详细的错误信息
             char errBuf[256];
-            unsigned long errCode = ERR_get_error();
             ERR_error_string_n(errCode, errBuf, sizeof(errBuf));
             LOG_ERROR << "SSL handshake failed: " << errBuf;
+            state_ = SSLState::ERROR;
             conn_->shutdown();  // 关闭连接
             break;
         }
     }
 }
 
-void SslConnection::onEncrypted(const char* data, size_t len) 
-{
-    writeBuffer_.append(data, len);
-    conn_->send(&writeBuffer_);
-}
-
-void SslConnection::onDecrypted(const char* data, size_t len) 
+// 将累积的密文交给 TcpConnection，在 IO 线程中 send(Buffer*) 会直接写 socket
+void SslConnection::flushEncrypted()
 {
-    decryptedBuffer_.append(data, len);
+    if (writeBuffer_.readableBytes() > 0) {
+        conn_->send(&writeBuffer_);
+    }
 }
 
-SSLError SslConnection::getLastError(int ret) 
+SSLError SslConnection::getLastError(int ret)
 {
     int err = SSL_get_error(ssl_, ret);
-    switch (err) 
+    switch (err)
     {
         case SSL_ERROR_NONE:
             return SSLError::NONE;
@@ -187,9 +358,9 @@ SSLError SslConnection::getLastError(int ret)
     }
 }
 
-void SslConnection::handleError(SSLError error) 
+void SslConnection::handleError(SSLError error)
 {
-    switch (error) 
+    switch (error)
     {
         case SSLError::WANT_READ:
         case SSLError::WANT_WRITE:
@@ -200,6 +371,7 @@ void SslConnection::handleError(SSLError error)
         case SSLError::UNKNOWN:
             LOG_ERROR << "SSL error occurred: " << ERR_error_string(ERR_get_error(), nullptr);
             state_ = SSLState::ERROR;
+            flushEncrypted();
             conn_->shutdown();
             break;
         default:
@@ -207,42 +379,55 @@ void SslConnection::handleError(SSLError error)
     }
 }
 
-int SslConnection::bioWrite(BIO* bio, const char* data, int len) 
+int SslConnection::bioWrite(BIO* bio, const char* data, int len)
 {
     SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
     if (!conn) return -1;
 
-    conn->conn_->send(data, len);
+    BIO_clear_retry_flags(bio);
+    conn->writeBuffer_.append(data, len);
     return len;
 }
 
-int SslConnection::bioRead(BIO* bio, char* data, int len) 
+int SslConnection::bioRead(BIO* bio, char* data, int len)
 {
     SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
     if (!conn) return -1;
 
-    size_t readable = conn->readBuffer_.readableBytes();
-    if (readable == 0) 
+    BIO_clear_retry_flags(bio);
+    size_t readable = conn->input_ ? conn->input_->readableBytes() : 0;
+    if (readable == 0)
     {
-        return -1;  // 无数据可读
+        BIO_set_retry_read(bio);  // 无数据可读，等待下一次 onRead
+        return -1;
     }
 
     size_t toRead = std::min(static_cast<size_t>(len), readable);
-    memcpy(data, conn->readBuffer_.peek(), toRead);
-    conn->readBuffer_.retrieve(toRead);
-    return toRead;
+    memcpy(data, conn->input_->peek(), toRead);
+    conn->input_->retrieve(toRead);
+    return static_cast<int>(toRead);
 }
 
-long SslConnection::bioCtrl(BIO* bio, int cmd, long num, void* ptr) 
+long SslConnection::bioCtrl(BIO* bio, int cmd, long num, void* ptr)
 {
-    switch (cmd) 
+    switch (cmd)
     {
         case BIO_CTRL_FLUSH:
             return 1;
+        case BIO_CTRL_PENDING:
+        {
+            SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
+            return (conn && conn->input_) ? static_cast<long>(conn->input_->readableBytes()) : 0;
+        }
+        case BIO_CTRL_WPENDING:
+        {
+            SslConnection* conn = static_cast<SslConnection*>(BIO_get_data(bio));
+            return conn ? static_cast<long>(conn->writeBuffer_.readableBytes()) : 0;
+        }
         default:
             return 0;
     }
 }
 
 
-} // namespace ssl 
\ No newline at end of file
+} // namespace ssl
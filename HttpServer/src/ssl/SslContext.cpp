@@ -1,9 +1,94 @@
 #include "../../include/ssl/SslContext.h"
+#include "../../include/ssl/SslConnection.h"
 #include <muduo/base/Logging.h>
+#include <openssl/core_names.h>
 #include <openssl/err.h>
+#include <openssl/rand.h>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
 
 namespace ssl
 {
+
+// 会话只在同一服务的上下文之间复用
+static const unsigned char kSessionIdContext[] = "HttpServer";
+
+
+// 证书文件的修改时间与大小，用于检测证书更新
+struct FileStamp
+{
+    std::string path;
+    int64_t     mtimeNs;
+    int64_t     size;
+
+    bool operator==(const FileStamp& other) const
+    {
+        return mtimeNs == other.mtimeNs && size == other.size;
+    }
+};
+
+static FileStamp fileStamp(const std::string& path)
+{
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+    {
+        return {path, -1, -1};
+    }
+    return {path, st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, static_cast<int64_t>(st.st_size)};
+}
+
+// 一次加载得到的全部证书，加载后不再修改，重新加载时整体替换
+// 握手中的 SSL 对象通过 SSL_set_SSL_CTX 持有所选证书上下文的引用，替换后旧证书在握手结束后才释放
+struct SslContext::CertificateSet
+{
+    SSL_CTX*                                  defaultCtx = nullptr; // 默认证书
+    std::vector<SSL_CTX*>                     contexts; // 持有的全部证书上下文
+    std::unordered_map<std::string, SSL_CTX*> byName; // 小写主机名（含 "*." 通配符）-> 证书上下文
+    std::vector<FileStamp>                    files; // 加载时各文件的状态
+
+    ~CertificateSet()
+    {
+        for (SSL_CTX* ctx : contexts)
+        {
+            SSL_CTX_free(ctx);
+        }
+    }
+
+    // 精确匹配优先，其次匹配一级通配符，都不匹配时返回默认证书
+    SSL_CTX* select(const char* serverName) const
+    {
+        if (!serverName || byName.empty())
+        {
+            return defaultCtx;
+        }
+        std::string name(serverName);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        auto it = byName.find(name);
+        if (it != byName.end())
+        {
+            return it->second;
+        }
+        size_t dot = name.find('.');
+        if (dot != std::string::npos)
+        {
+            it = byName.find("*" + name.substr(dot));
+            if (it != byName.end())
+            {
+                return it->second;
+            }
+        }
+        return defaultCtx;
+    }
+};
+
 SslContext::SslContext(const SslConfig& config)
     : ctx_(nullptr)
     , config_(config)
@@ -11,8 +96,23 @@ SslContext::SslContext(const SslConfig& config)
 
 }
 
+// 原子地把 value 更新为 max(value, v)
+template <typename T>
+static void updateMax(std::atomic<T>& value, T v)
+{
+    T current = value.load(std::memory_order_relaxed);
+    while (v > current && !value.compare_exchange_weak(current, v, std::memory_order_relaxed))
+    {
+    }
+}
+
 SslContext::~SslContext()
 {
+    // 先停止握手线程，避免其仍在使用 SSL_CTX
+    if (handshakePool_)
+    {
+        handshakePool_->stop();
+    }
     if (ctx_)
     {
         SSL_CTX_free(ctx_);
@@ -40,11 +140,14 @@ bool SslContext::initialize()
                   SSL_OP_CIPHER_SERVER_PREFERENCE;
     SSL_CTX_set_options(ctx_, options);
 
-    // 加载证书和私钥
-    if (!loadCertificates())
+    // 加载证书和私钥，握手时按 SNI 选择
+    certificates_ = loadCertificates();
+    if (!certificates_)
     {
         return false;
     }
+    SSL_CTX_set_tlsext_servername_callback(ctx_, serverNameCallback);
+    SSL_CTX_set_tlsext_servername_arg(ctx_, this);
 
     // 设置协议版本
     if (!setupProtocol())
@@ -52,72 +155,177 @@ bool SslContext::initialize()
         return false;
     }
 
-    // 设置会话缓存
-    setupSessionCache();
+    // 设置会话缓存和会话票据
+    if (!setupSessionCache())
+    {
+        return false;
+    }
+
+    if (config_.getHandshakeThreads() > 0)
+    {
+        handshakePool_ = std::make_unique<muduo::ThreadPool>("ssl-handshake");
+        handshakePool_->start(config_.getHandshakeThreads());
+    }
 
     LOG_INFO << "SSL context initialized successfully";
     return true;
 }
 
-bool SslContext::loadCertificates()
+std::shared_ptr<const SslContext::CertificateSet> SslContext::loadCertificates()
+{
+    auto certs = std::make_shared<CertificateSet>();
+    // 先记录文件状态再读取，读取期间文件被修改会在下一次检查时再次加载
+    auto addFiles = [&certs](const std::string& certFile, const std::string& keyFile,
+                             const std::string& chainFile) {
+        for (const std::string* file : {&certFile, &keyFile, &chainFile})
+        {
+            if (!file->empty())
+            {
+                certs->files.push_back(fileStamp(*file));
+            }
+        }
+    };
+
+    addFiles(config_.getCertificateFile(), config_.getPrivateKeyFile(), config_.getCertificateChainFile());
+    certs->defaultCtx = createCertificateContext(config_.getCertificateFile(),
+                                                 config_.getPrivateKeyFile(),
+                                                 config_.getCertificateChainFile());
+    if (!certs->defaultCtx)
+    {
+        return nullptr;
+    }
+    certs->contexts.push_back(certs->defaultCtx);
+
+    for (const CertificateEntry& entry : config_.getCertificates())
+    {
+        addFiles(entry.certFile, entry.keyFile, entry.chainFile);
+        SSL_CTX* ctx = createCertificateContext(entry.certFile, entry.keyFile, entry.chainFile);
+        if (!ctx)
+        {
+            LOG_ERROR << "Failed to load certificate for " << entry.serverName;
+            return nullptr;
+        }
+        certs->contexts.push_back(ctx);
+        std::string name = entry.serverName;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        certs->byName[name] = ctx;
+    }
+    return certs;
+}
+
+// 只承载证书和私钥的上下文，握手时切换到它；会话缓存、票据、协议版本仍由 ctx_ 负责
+SSL_CTX* SslContext::createCertificateContext(const std::string& certFile,
+                                              const std::string& keyFile,
+                                              const std::string& chainFile)
 {
+    SSL_CTX* ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx)
+    {
+        handleSslError("Failed to create SSL context");
+        return nullptr;
+    }
+    // 切换后 SSL_get_SSL_CTX 返回该上下文，回调仍需找到本对象；会话 ID 上下文须一致才能复用会话
+    SSL_CTX_set_app_data(ctx, this);
+    SSL_CTX_set_session_id_context(ctx, kSessionIdContext, sizeof(kSessionIdContext) - 1);
     // 加载证书
-    if (SSL_CTX_use_certificate_file(ctx_,
-     config_.getCertificateFile().c_str(), SSL_FILETYPE_PEM) <= 0)
+    if (SSL_CTX_use_certificate_file(ctx, certFile.c_str(), SSL_FILETYPE_PEM) <= 0)
     {
         handleSslError("Failed to load server certificate");
-        return false;
+        SSL_CTX_free(ctx);
+        return nullptr;
     }
 
     // 加载私钥
-    if (SSL_CTX_use_PrivateKey_file(ctx_, 
-        config_.getPrivateKeyFile().c_str(), SSL_FILETYPE_PEM) <= 0)
+    if (SSL_CTX_use_PrivateKey_file(ctx, keyFile.c_str(), SSL_FILETYPE_PEM) <= 0)
     {
         handleSslError("Failed to load private key");
-        return false;
+        SSL_CTX_free(ctx);
+        return nullptr;
     }
 
     // 验证私钥
-    if (!SSL_CTX_check_private_key(ctx_))
+    if (!SSL_CTX_check_private_key(ctx))
     {
         handleSslError("Private key does not match the certificate");
-        return false;
+        SSL_CTX_free(ctx);
+        return nullptr;
     }
 
     // 加载证书链
-    if (!config_.getCertificateChainFile().empty())
+    if (!chainFile.empty())
     {
-        if (SSL_CTX_use_certificate_chain_file(ctx_,
-            config_.getCertificateChainFile().c_str()) <= 0)
+        if (SSL_CTX_use_certificate_chain_file(ctx, chainFile.c_str()) <= 0)
         {
             handleSslError("Failed to load certificate chain");
-            return false;
+            SSL_CTX_free(ctx);
+            return nullptr;
         }
     }
 
+    return ctx;
+}
+
+bool SslContext::reloadCertificates()
+{
+    std::lock_guard<std::mutex> lock(reloadMutex_);
+    std::shared_ptr<const CertificateSet> certs = loadCertificates();
+    if (!certs)
+    {
+        LOG_ERROR << "Failed to reload certificates, keeping the current ones";
+        return false;
+    }
+    std::atomic_store(&certificates_, certs);
+    LOG_INFO << "Certificates reloaded";
     return true;
 }
 
+bool SslContext::reloadCertificatesIfChanged()
+{
+    std::shared_ptr<const CertificateSet> current = std::atomic_load(&certificates_);
+    for (const FileStamp& file : current->files)
+    {
+        if (!(fileStamp(file.path) == file))
+        {
+            return reloadCertificates();
+        }
+    }
+    return false;
+}
+
+// 按客户端请求的主机名选择证书，没有 SNI 时也会调用
+int SslContext::serverNameCallback(SSL* ssl, int* alert, void* arg)
+{
+    SslContext* self = static_cast<SslContext*>(arg);
+    std::shared_ptr<const CertificateSet> certs = std::atomic_load(&self->certificates_);
+    SSL_CTX* selected = certs->select(SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name));
+    if (selected != SSL_get_SSL_CTX(ssl))
+    {
+        SSL_set_SSL_CTX(ssl, selected);  // SSL 对象持有 selected 的引用
+    }
+    return SSL_TLSEXT_ERR_OK;
+}
+
 bool SslContext::setupProtocol()
 {
-    // 设置 SSL/TLS 协议版本
-    long options = SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3;
+    // 设置 SSL/TLS 协议版本：配置的版本为允许的最低版本
+    int minVersion = TLS1_2_VERSION;
     switch (config_.getProtocolVersion())
     {
         case SSLVersion::TLS_1_0:
-            options |= SSL_OP_NO_TLSv1;
+            minVersion = TLS1_VERSION;
             break;
         case SSLVersion::TLS_1_1:
-            options |= SSL_OP_NO_TLSv1_1;
+            minVersion = TLS1_1_VERSION;
             break;
         case SSLVersion::TLS_1_2:
-            options |= SSL_OP_NO_TLSv1_2;
+            minVersion = TLS1_2_VERSION;
             break;
         case SSLVersion::TLS_1_3:
-            options |= SSL_OP_NO_TLSv1_3;
+            minVersion = TLS1_3_VERSION;
             break;
     }
-    SSL_CTX_set_options(ctx_, options);
+    SSL_CTX_set_min_proto_version(ctx_, minVersion);
     
     // 设置加密套件
     if (!config_.getCipherList().empty())
@@ -133,11 +341,210 @@ bool SslContext::setupProtocol()
     return true;
 }
 
-void SslContext::setupSessionCache()
+bool SslContext::setupSessionCache()
 {
+    SSL_CTX_set_app_data(ctx_, this);
+    SSL_CTX_set_session_id_context(ctx_, kSessionIdContext, sizeof(kSessionIdContext) - 1);
     SSL_CTX_set_session_cache_mode(ctx_, SSL_SESS_CACHE_SERVER);
     SSL_CTX_sess_set_cache_size(ctx_, config_.getSessionCacheSize());
     SSL_CTX_set_timeout(ctx_, config_.getSessionTimeout());
+
+    if (config_.getSessionTickets())
+    {
+        std::string secret;
+        if (!config_.getTicketKeyFile().empty())
+        {
+            std::ifstream file(config_.getTicketKeyFile(), std::ios::binary);
+            secret.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (secret.size() < 32)
+            {
+                LOG_ERROR << "Session ticket key file " << config_.getTicketKeyFile()
+                          << " must contain at least 32 bytes";
+                return false;
+            }
+        }
+        ticketKeys_.reset(new SessionTicketKeys(secret, config_.getTicketKeyRotation(),
+                                                config_.getSessionTimeout()));
+        OPENSSL_cleanse(&secret[0], secret.size());
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx_, ticketKeyCallback);
+    }
+    else
+    {
+        // 不签发无状态票据，TLS 1.3 改用缓存中的有状态会话
+        SSL_CTX_set_options(ctx_, SSL_OP_NO_TICKET);
+    }
+
+    if (!config_.getSharedCachePath().empty())
+    {
+        sharedCache_.reset(new SharedSessionCache(config_.getSharedCachePath(),
+                                                  config_.getSharedCacheSlots()));
+        if (sharedCache_->valid())
+        {
+            SSL_CTX_sess_set_new_cb(ctx_, newSessionCallback);
+            SSL_CTX_sess_set_get_cb(ctx_, getSessionCallback);
+            SSL_CTX_sess_set_remove_cb(ctx_, removeSessionCallback);
+        }
+    }
+    return true;
+}
+
+SslContext::SessionStats SslContext::getSessionStats() const
+{
+    SessionStats stats;
+    stats.fullHandshakes = counters_.fullHandshakes.load(std::memory_order_relaxed);
+    stats.resumedHandshakes = counters_.resumedHandshakes.load(std::memory_order_relaxed);
+    stats.ticketsIssued = counters_.ticketsIssued.load(std::memory_order_relaxed);
+    stats.ticketsAccepted = counters_.ticketsAccepted.load(std::memory_order_relaxed);
+    stats.ticketsRenewed = counters_.ticketsRenewed.load(std::memory_order_relaxed);
+    stats.ticketsRejected = counters_.ticketsRejected.load(std::memory_order_relaxed);
+    stats.cacheHits = counters_.cacheHits.load(std::memory_order_relaxed);
+    stats.cacheMisses = counters_.cacheMisses.load(std::memory_order_relaxed);
+    stats.cacheStores = counters_.cacheStores.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SslContext::HandshakeStats SslContext::getHandshakeStats() const
+{
+    HandshakeStats stats;
+    stats.handshakes = counters_.handshakes.load(std::memory_order_relaxed);
+    stats.totalLatencyUs = counters_.totalLatencyUs.load(std::memory_order_relaxed);
+    stats.maxLatencyUs = counters_.maxLatencyUs.load(std::memory_order_relaxed);
+    stats.offloaded = counters_.offloaded.load(std::memory_order_relaxed);
+    stats.totalQueueWaitUs = counters_.totalQueueWaitUs.load(std::memory_order_relaxed);
+    stats.queueDepth = counters_.queueDepth.load(std::memory_order_relaxed);
+    stats.maxQueueDepth = counters_.maxQueueDepth.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SslContext::runHandshakeTask(std::function<void()> task)
+{
+    int64_t depth = counters_.queueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+    updateMax(counters_.maxQueueDepth, depth);
+    muduo::Timestamp queued = muduo::Timestamp::now();
+    handshakePool_->run([this, queued, task = std::move(task)] {
+        counters_.queueDepth.fetch_sub(1, std::memory_order_relaxed);
+        counters_.offloaded.fetch_add(1, std::memory_order_relaxed);
+        int64_t waitUs = muduo::Timestamp::now().microSecondsSinceEpoch() - queued.microSecondsSinceEpoch();
+        counters_.totalQueueWaitUs.fetch_add(static_cast<uint64_t>(waitUs), std::memory_order_relaxed);
+        task();
+    });
+}
+
+void SslContext::onHandshakeCompleted(bool resumed, int64_t latencyUs)
+{
+    counters_.handshakes.fetch_add(1, std::memory_order_relaxed);
+    counters_.totalLatencyUs.fetch_add(static_cast<uint64_t>(latencyUs), std::memory_order_relaxed);
+    updateMax(counters_.maxLatencyUs, static_cast<uint64_t>(latencyUs));
+
+    if (resumed)
+    {
+        counters_.resumedHandshakes.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        counters_.fullHandshakes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// 票据加解密回调：enc 为 1 时用当前密钥签发，为 0 时按密钥名查找解密密钥
+// 返回 1 表示成功，2 表示成功但需要用当前密钥重新签发，0 表示票据无法解密（走完整握手）
+int SslContext::ticketKeyCallback(SSL* ssl, unsigned char* keyName, unsigned char* iv,
+                                  EVP_CIPHER_CTX* cipherCtx, EVP_MAC_CTX* macCtx, int enc)
+{
+    SslContext* self = static_cast<SslContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    SessionTicketKeys::Key key;
+    bool isCurrent = true;
+    if (enc)
+    {
+        key = self->ticketKeys_->current();
+        memcpy(keyName, key.name, sizeof(key.name));
+        if (RAND_bytes(iv, 16) != 1)
+        {
+            OPENSSL_cleanse(&key, sizeof(key));
+            return -1;
+        }
+    }
+    else if (!self->ticketKeys_->find(keyName, &key, &isCurrent))
+    {
+        self->counters_.ticketsRejected.fetch_add(1, std::memory_order_relaxed);
+        return 0;
+    }
+
+    char digest[] = "SHA256";
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmacKey, sizeof(key.hmacKey)),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digest, 0),
+        OSSL_PARAM_construct_end()
+    };
+    int ok = EVP_MAC_CTX_set_params(macCtx, params)
+          && (enc ? EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv)
+                  : EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv));
+    OPENSSL_cleanse(&key, sizeof(key));
+    if (!ok)
+    {
+        return -1;
+    }
+
+    if (enc)
+    {
+        self->counters_.ticketsIssued.fetch_add(1, std::memory_order_relaxed);
+        return 1;
+    }
+    if (isCurrent)
+    {
+        self->counters_.ticketsAccepted.fetch_add(1, std::memory_order_relaxed);
+        return 1;
+    }
+    self->counters_.ticketsRenewed.fetch_add(1, std::memory_order_relaxed);
+    return 2;
+}
+
+int SslContext::newSessionCallback(SSL* ssl, SSL_SESSION* session)
+{
+    SslContext* self = static_cast<SslContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    int length = i2d_SSL_SESSION(session, nullptr);
+    if (length <= 0 || static_cast<size_t>(length) > SharedSessionCache::kMaxSessionLength)
+    {
+        return 0;
+    }
+
+    unsigned char data[SharedSessionCache::kMaxSessionLength];
+    unsigned char* p = data;
+    i2d_SSL_SESSION(session, &p);
+    unsigned int idLength = 0;
+    const unsigned char* id = SSL_SESSION_get_id(session, &idLength);
+    int64_t expire = SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+    if (self->sharedCache_->store(id, idLength, data, length, expire))
+    {
+        self->counters_.cacheStores.fetch_add(1, std::memory_order_relaxed);
+    }
+    OPENSSL_cleanse(data, length);
+    return 0; // 不持有 session 的引用
+}
+
+SSL_SESSION* SslContext::getSessionCallback(SSL* ssl, const unsigned char* id, int len, int* copy)
+{
+    SslContext* self = static_cast<SslContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    *copy = 0;
+    std::string data;
+    if (!self->sharedCache_->lookup(id, len, &data))
+    {
+        self->counters_.cacheMisses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    self->counters_.cacheHits.fetch_add(1, std::memory_order_relaxed);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data.data());
+    SSL_SESSION* session = d2i_SSL_SESSION(nullptr, &p, static_cast<long>(data.size()));
+    OPENSSL_cleanse(&data[0], data.size());
+    return session;
+}
+
+void SslContext::removeSessionCallback(SSL_CTX* ctx, SSL_SESSION* session)
+{
+    SslContext* self = static_cast<SslContext*>(SSL_CTX_get_app_data(ctx));
+    unsigned int idLength = 0;
+    const unsigned char* id = SSL_SESSION_get_id(session, &idLength);
+    self->sharedCache_->remove(id, idLength);
 }
 
 void SslContext::handleSslError(const char* msg)
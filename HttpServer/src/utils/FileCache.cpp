@@ -0,0 +1,113 @@
+#include "../../include/utils/FileCache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include <muduo/base/Logging.h>
+
+namespace http
+{
+
+static int64_t mtimeNs(const struct stat& st)
+{
+    return st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+MappedFilePtr FileCache::get(const std::string& path)
+{
+    auto now = std::chrono::steady_clock::now();
+    MappedFilePtr cached;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end())
+        {
+            if (now - it->second.checkedAt < revalidateInterval_)
+            {
+                return it->second.file;
+            }
+            cached = it->second.file;
+        }
+    }
+
+    // stat 和重新打开都在锁外进行，并发的请求最多各自打开一次
+    struct stat st;
+    if (cached && ::stat(path.c_str(), &st) == 0 && mtimeNs(st) == cached->mtimeNs_
+        && static_cast<size_t>(st.st_size) == cached->size_ && st.st_ino == cached->inode_)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[path].checkedAt = now;
+        return cached;
+    }
+
+    MappedFilePtr file = open(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file)
+    {
+        entries_[path] = Entry{file, now};
+    }
+    else
+    {
+        entries_.erase(path);
+    }
+    return file;
+}
+
+void FileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+MappedFilePtr FileCache::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> file(new MappedFile);
+    file->fd_ = fd;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        return nullptr;
+    }
+    file->size_ = static_cast<size_t>(st.st_size);
+    file->mtime_ = st.st_mtime;
+    file->mtimeNs_ = mtimeNs(st);
+    file->inode_ = st.st_ino;
+
+    // 空文件无法映射
+    if (file->size_ > 0)
+    {
+        void* addr = ::mmap(nullptr, file->size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED)
+        {
+            LOG_ERROR << "mmap " << path << " failed: " << strerror(errno);
+            return nullptr;
+        }
+        file->data_ = static_cast<const char*>(addr);
+    }
+    LOG_INFO << "File " << path << " mapped (" << file->size_ << " bytes)";
+    return file;
+}
+
+} // namespace http
@@ -0,0 +1,117 @@
+#include "../../include/utils/SecureRandom.h"
+
+#include <muduo/base/Logging.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+namespace http
+{
+
+// 每次从内核取的随机字节数
+static const size_t kBufferSize = 4096;
+
+// fork 时加一，线程局部缓冲区据此判断内容是否与父进程重复
+static std::atomic<unsigned> forkGeneration{0};
+
+static void onFork()
+{
+    forkGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
+static bool registerForkHandler()
+{
+    return ::pthread_atfork(nullptr, nullptr, onFork) == 0;
+}
+
+struct RandomBuffer
+{
+    unsigned char data[kBufferSize];
+    size_t        pos = kBufferSize; // 下一个未使用的字节
+    unsigned      generation = 0;
+
+    ~RandomBuffer()
+    {
+        OPENSSL_cleanse(data, sizeof data);
+    }
+
+    void refill()
+    {
+        size_t filled = 0;
+        while (filled < kBufferSize)
+        {
+            ssize_t n = ::getrandom(data + filled, kBufferSize - filled, 0);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // 内核不支持 getrandom 时退回 OpenSSL 的 DRBG
+                if (RAND_bytes(data + filled, static_cast<int>(kBufferSize - filled)) != 1)
+                {
+                    LOG_FATAL << "Failed to obtain random bytes";
+                }
+                break;
+            }
+            filled += static_cast<size_t>(n);
+        }
+        pos = 0;
+    }
+};
+
+void secureRandomBytes(void* out, size_t len)
+{
+    static bool registered = registerForkHandler();
+    (void)registered;
+
+    thread_local RandomBuffer buffer;
+    unsigned generation = forkGeneration.load(std::memory_order_relaxed);
+    if (buffer.generation != generation)
+    {
+        buffer.generation = generation;
+        buffer.pos = kBufferSize;
+    }
+
+    unsigned char* dest = static_cast<unsigned char*>(out);
+    while (len > 0)
+    {
+        if (buffer.pos == kBufferSize)
+        {
+            buffer.refill();
+        }
+        size_t n = std::min(len, kBufferSize - buffer.pos);
+        memcpy(dest, buffer.data + buffer.pos, n);
+        // 取出的字节立即从缓冲区抹掉，避免之后泄露已发出的随机数
+        OPENSSL_cleanse(buffer.data + buffer.pos, n);
+        buffer.pos += n;
+        dest += n;
+        len -= n;
+    }
+}
+
+void secureRandomHex(char* out, size_t len)
+{
+    static const char kHex[] = "0123456789abcdef";
+    unsigned char bytes[64];
+    while (len > 0)
+    {
+        size_t n = std::min(len, sizeof bytes);
+        secureRandomBytes(bytes, n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            *out++ = kHex[bytes[i] >> 4];
+            *out++ = kHex[bytes[i] & 0x0f];
+        }
+        len -= n;
+    }
+    OPENSSL_cleanse(bytes, sizeof bytes);
+}
+
+} // namespace http
@@ -9,6 +9,8 @@
 
 #include "AiGame.h"
 #include "../../../HttpServer/include/http/HttpServer.h"
+#include "../../../HttpServer/include/http/HtmlTemplate.h"
+#include "../../../HttpServer/include/session/PersistentSessionStorage.h"
 #include "../../../HttpServer/include/utils/MysqlUtil.h"
 #include "../../../HttpServer/include/utils/FileUtil.h"
 #include "../../../HttpServer/include/utils/JsonUtil.h"
@@ -36,6 +38,7 @@ public:
                  muduo::net::TcpServer::Option option = muduo::net::TcpServer::kNoReusePort);
 
     void setThreadNum(int numThreads);
+    void setWorkerThreadNum(int numThreads);
     void start();
 private:
     void initialize();
@@ -59,6 +62,17 @@ private:
     void packageResp(const std::string& version, http::HttpResponse::HttpStatusCode statusCode,
                      const std::string& statusMsg, bool close, const std::string& contentType,
                      int contentLen, const std::string& body, http::HttpResponse* resp);
+    void packageFileResp(const http::HttpRequest& req, const std::string& filePath,
+                         const std::string& contentType, http::HttpResponse* resp);
+    std::string loadPage(const std::string& filePath);
+    // 需要注入 userId 的页面，scriptSlot 为编译时取得的 userScript 插槽序号
+    struct UserPage
+    {
+        http::HtmlTemplatePtr page;
+        int                   scriptSlot;
+    };
+    UserPage compileUserPage(const std::string& filePath);
+    void renderUserPage(const UserPage& page, int userId, http::HttpResponse* resp);
 
     // 获取历史最高在线人数
     int getMaxOnline() const
@@ -119,4 +133,7 @@ private:
     std::mutex                                       mutexForOnlineUsers_; 
     // 最高在线人数
     std::atomic<int>                                 maxOnline_;
+    // 需要注入 userId 的页面，启动时预编译
+    UserPage                                         menuPage_;
+    UserPage                                         chatPage_;
 };
\ No newline at end of file
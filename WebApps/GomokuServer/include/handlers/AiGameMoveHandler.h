@@ -8,5 +8,7 @@ public:
     explicit AiGameMoveHandler(GomokuServer* server) : server_(server) {}
     void handle(const http::HttpRequest& req, http::HttpResponse* resp) override;
 private:
+    void play(int userId, int x, int y, const std::string& version, http::HttpResponse* resp);
+
     GomokuServer* server_;
 };
\ No newline at end of file
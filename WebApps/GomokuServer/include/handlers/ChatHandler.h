@@ -20,6 +20,9 @@ private:
     // 处理聊天完成请求
     void handleChatCompletion(const http::HttpRequest& req, http::HttpResponse* resp);
     
+    // 调用API并封装响应
+    void completeChat(const std::string& userMessage, const std::string& version, http::HttpResponse* resp);
+
     // 调用火山方舟API
     std::string callVolcanoArkAPI(const std::string& userMessage);
     
@@ -27,6 +27,11 @@ void GomokuServer::setThreadNum(int numThreads)
     httpServer_.setThreadNum(numThreads);
 }
 
+void GomokuServer::setWorkerThreadNum(int numThreads)
+{
+    httpServer_.setWorkerThreadNum(numThreads);
+}
+
 void GomokuServer::start()
 {
     httpServer_.start();
@@ -42,12 +47,23 @@ void GomokuServer::initialize()
     initializeMiddleware();
     // 初始化路由
     initializeRouter();
+    // 预加载并预压缩页面
+    httpServer_.getStaticAssets()->loadDirectory("../WebApps/GomokuServer/resource");
+    menuPage_ = compileUserPage("../WebApps/GomokuServer/resource/menu.html");
+    chatPage_ = compileUserPage("../WebApps/GomokuServer/resource/Chat.html");
 }
 
 void GomokuServer::initializeSession()
 {
-    // 创建会话存储
-    auto sessionStorage = std::make_unique<http::session::MemorySessionStorage>();
+    // 配置了密钥时会话保存在签名 cookie 中，多个进程或主机只要使用相同密钥即可处理任何用户的请求
+    if (const char* secret = ::getenv("GOMOKU_SESSION_SECRET"))
+    {
+        auto codec = std::make_shared<http::session::SessionCookieCodec>(std::vector<std::string>{secret});
+        setSessionManager(std::make_unique<http::session::SessionManager>(codec));
+        return;
+    }
+    // 创建会话存储，会话记录在日志文件中，服务器重启后用户不需要重新登录
+    auto sessionStorage = std::make_unique<http::session::PersistentSessionStorage>("gomoku_sessions.log");
     // 创建会话管理器
     auto sessionManager = std::make_unique<http::session::SessionManager>(std::move(sessionStorage));
     // 设置会话管理器
@@ -224,3 +240,68 @@ void GomokuServer::packageResp(const std::string &version,
     }
 }
 
+
+// 以缓存的页面作为响应体：优先使用预压缩的静态资源，不在其中时从文件映射发送
+void GomokuServer::packageFileResp(const http::HttpRequest &req,
+                                   const std::string &filePath,
+                                   const std::string &contentType,
+                                   http::HttpResponse *resp)
+{
+    if (httpServer_.getStaticAssets()->serve(filePath, req, resp))
+    {
+        return;
+    }
+
+    http::MappedFilePtr file = httpServer_.getFileCache()->get(filePath);
+    if (!file)
+    {
+        LOG_WARN << filePath << " not exist";
+        std::string body("<h1>404 Not Found</h1>");
+        packageResp(req.getVersion(), http::HttpResponse::k404NotFound, "Not Found", false,
+                    "text/html", body.size(), body, resp);
+        return;
+    }
+
+    resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+    resp->setCloseConnection(false);
+    resp->setContentType(contentType);
+    resp->setFileBody(std::move(file));
+}
+
+// 读取缓存的页面原文，静态资源缓存中没有时从文件缓存读取，都没有时返回空串
+std::string GomokuServer::loadPage(const std::string &filePath)
+{
+    auto asset = httpServer_.getStaticAssets()->find(filePath);
+    if (asset)
+    {
+        return asset->variants[http::StaticAssetCache::kIdentity].body;
+    }
+    http::MappedFilePtr file = httpServer_.getFileCache()->get(filePath);
+    if (!file)
+    {
+        LOG_WARN << filePath << " not exist";
+        return std::string();
+    }
+    return std::string(file->data(), file->size());
+}
+
+// 预编译需要注入 userId 的页面，插槽 userScript 位于 </head> 之前
+GomokuServer::UserPage GomokuServer::compileUserPage(const std::string &filePath)
+{
+    std::shared_ptr<http::HtmlTemplate> page = http::HtmlTemplate::compile(loadPage(filePath));
+    if (!page->addSlotBefore("</head>", "userScript"))
+    {
+        LOG_WARN << filePath << " has no </head>, userId will not be injected";
+    }
+    return UserPage{page, page->slotIndex("userScript")};
+}
+
+void GomokuServer::renderUserPage(const UserPage &page, int userId, http::HttpResponse *resp)
+{
+    std::vector<std::string> values(page.page->slotCount());
+    if (page.scriptSlot >= 0)
+    {
+        values[page.scriptSlot] = "<script>const userId = '" + std::to_string(userId) + "';</script>";
+    }
+    page.page->render(std::move(values), resp);
+}
@@ -25,13 +25,46 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
         int x = request["x"];
         int y = request["y"];
 
+        // AI落子较慢（含500ms延时和极小极大搜索），转为延迟响应交给工作线程执行，不阻塞IO线程
+        std::shared_ptr<http::ResponseWriter> writer = resp->defer();
+        if (!writer)
+        {
+            play(userId, x, y, req.getVersion(), resp);
+            return;
+        }
+
+        std::string version = req.getVersion();
+        server_->httpServer_.runInWorker([this, writer, userId, x, y, version]() {
+            play(userId, x, y, version, writer->response());
+            writer->done();
+        });
+    }
+    catch (const std::exception &e)
+    { 
+        json response = {
+            {"status", "error"},
+            {"message", e.what()}};
+        std::string responseBody = response.dump();
+        server_->packageResp(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error", false, "application/json", responseBody.size(), responseBody, resp);
+    }
+}
+
+// 处理一步落子并封装响应，可能在工作线程中执行
+void AiGameMoveHandler::play(int userId, int x, int y, const std::string &version, http::HttpResponse *resp)
+{
+    try
+    {
         // 获取或创建游戏实例
-        if (server_->aiGames_.find(userId) == server_->aiGames_.end())
+        std::shared_ptr<AiGame> game;
         {
             std::lock_guard<std::mutex> lock(server_->mutexForAiGames_);
-            server_->aiGames_[userId] = std::make_shared<AiGame>(userId);
+            auto &slot = server_->aiGames_[userId];
+            if (!slot)
+            {
+                slot = std::make_shared<AiGame>(userId);
+            }
+            game = slot;
         }
-        auto &game = server_->aiGames_[userId];
 
         // 处理人类玩家移动
         if (!game->humanMove(x, y))
@@ -41,7 +74,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
                 {"message", "Invalid move"}};
             std::string responseBody = response.dump();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
+            resp->setStatusLine(version, http::HttpResponse::k400BadRequest, "Bad Request");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
             resp->setContentLength(responseBody.size());
@@ -59,7 +92,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
                 {"next_turn", "none"}};
             std::string responseBody = response.dump();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+            resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
             resp->setContentLength(responseBody.size());
@@ -82,7 +115,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
                 {"next_turn", "none"}};
             std::string responseBody = response.dump();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+            resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
             resp->setContentLength(responseBody.size());
@@ -109,7 +142,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
                 {"last_move", {{"x", game->getLastMove().first}, {"y", game->getLastMove().second}}}};
             std::string responseBody = response.dump();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+            resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
             resp->setContentLength(responseBody.size());
@@ -133,7 +166,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
                 {"last_move", {{"x", game->getLastMove().first}, {"y", game->getLastMove().second}}}};
             std::string responseBody = response.dump();
 
-            resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+            resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
             resp->setCloseConnection(false);
             resp->setContentType("application/json");
             resp->setContentLength(responseBody.size());
@@ -156,7 +189,7 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
 
         std::string responseBody = response.dump();
 
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
+        resp->setStatusLine(version, http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(false);
         resp->setContentType("application/json");
         resp->setContentLength(responseBody.size());
@@ -168,6 +201,6 @@ void AiGameMoveHandler::handle(const http::HttpRequest &req, http::HttpResponse
             {"status", "error"},
             {"message", e.what()}};
         std::string responseBody = response.dump();
-        server_->packageResp(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error", false, "application/json", responseBody.size(), responseBody, resp);
+        server_->packageResp(version, http::HttpResponse::k500InternalServerError, "Internal Server Error", false, "application/json", responseBody.size(), responseBody, resp);
     }
 }
\ No newline at end of file
@@ -68,31 +68,11 @@ void ChatHandler::handleChatPage(const http::HttpRequest& req, http::HttpRespons
     // 获取用户ID
     int userId = std::stoi(session->getValue("userId"));
     
-    // 读取聊天页面
-    std::string reqFile("../WebApps/GomokuServer/resource/Chat.html");
-    FileUtil fileOperater(reqFile);
-    if (!fileOperater.isValid()) {
-        LOG_WARN << reqFile << " not exist.";
-        fileOperater.resetDefaultFile();
-    }
-
-    std::vector<char> buffer(fileOperater.size());
-    fileOperater.readFile(buffer);
-    std::string chatHtml(buffer.data(), buffer.size());
-
-    // 在HTML中插入userId
-    size_t headEnd = chatHtml.find("</head>");
-    if (headEnd != std::string::npos) {
-        std::string script = "<script>const userId = '" + std::to_string(userId) + "';</script>";
-        chatHtml.insert(headEnd, script);
-    }
-
-    // 封装响应
+    // 封装响应，聊天页面已预编译为模板，在 </head> 之前注入 userId
     resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
     resp->setCloseConnection(false);
     resp->setContentType("text/html; charset=utf-8");
-    resp->setContentLength(chatHtml.size());
-    resp->setBody(chatHtml);
+    server_->renderUserPage(server_->chatPage_, userId, resp);
 }
 
 void ChatHandler::handleChatCompletion(const http::HttpRequest& req, http::HttpResponse* resp) {
@@ -116,12 +96,41 @@ void ChatHandler::handleChatCompletion(const http::HttpRequest& req, http::HttpR
         // 解析请求体
         json requestBody = json::parse(req.getBody());
         std::string userMessage = requestBody["message"];
+        std::string version = req.getVersion();
+        
+        // 调用火山方舟API是阻塞的网络请求，转为延迟响应交给工作线程执行，不阻塞IO线程
+        std::shared_ptr<http::ResponseWriter> writer = resp->defer();
+        if (!writer) {
+            completeChat(userMessage, version, resp);
+            return;
+        }
+        server_->httpServer_.runInWorker([this, writer, userMessage, version]() {
+            completeChat(userMessage, version, writer->response());
+            writer->done();
+        });
+    } catch (const std::exception& e) {
+        json errorResp;
+        errorResp["error"] = "Internal Error";
+        errorResp["message"] = e.what();
+        std::string errorBody = errorResp.dump();
         
+        // 错误响应设置
+        resp->setStatusLine(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error");
+        resp->setCloseConnection(true);
+        resp->setContentType("application/json");
+        resp->setContentLength(errorBody.size());
+        resp->setBody(errorBody);
+    }
+}
+
+// 调用API并封装响应，可能在工作线程中执行
+void ChatHandler::completeChat(const std::string& userMessage, const std::string& version, http::HttpResponse* resp) {
+    try {
         // 调用火山方舟API
         std::string apiResponse = callVolcanoArkAPI(userMessage);
         
         // 设置响应（现在可访问packageResp()，因已声明友元）
-        server_->packageResp(req.getVersion(), http::HttpResponse::k200Ok, "OK",
+        server_->packageResp(version, http::HttpResponse::k200Ok, "OK",
                             false, "application/json", apiResponse.size(),
                             apiResponse, resp);
     } catch (const std::exception& e) {
@@ -131,7 +140,7 @@ void ChatHandler::handleChatCompletion(const http::HttpRequest& req, http::HttpR
         std::string errorBody = errorResp.dump();
         
         // 错误响应设置
-        resp->setStatusLine(req.getVersion(), http::HttpResponse::k500InternalServerError, "Internal Server Error");
+        resp->setStatusLine(version, http::HttpResponse::k500InternalServerError, "Internal Server Error");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
         resp->setContentLength(errorBody.size());
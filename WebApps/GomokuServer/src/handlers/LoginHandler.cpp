@@ -4,10 +4,10 @@ void LoginHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp
 {
     // 处理登录逻辑
     // 验证 contentType
-    auto contentType = req.getHeader("Content-Type");
+    auto contentType = req.getHeader(http::HttpRequest::kContentType);
     if (contentType.empty() || contentType != "application/json" || req.getBody().empty())
     {
-        LOG_INFO << "content" << req.getBody();
+        LOG_INFO << "content" << std::string(req.getBody());
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k400BadRequest, "Bad Request");
         resp->setCloseConnection(true);
         resp->setContentType("application/json");
@@ -26,33 +26,11 @@ void MenuHandler::handle(const http::HttpRequest &req, http::HttpResponse *resp)
         int userId = std::stoi(session->getValue("userId"));
         std::string username = session->getValue("username");
 
-        std::string reqFile("../WebApps/GomokuServer/resource/menu.html");
-        FileUtil fileOperater(reqFile);
-        if (!fileOperater.isValid())
-        {
-            LOG_WARN << reqFile << "not exist.";
-            fileOperater.resetDefaultFile();
-        }
-
-        std::vector<char> buffer(fileOperater.size());
-        fileOperater.readFile(buffer); // 读出文件数据
-        std::string htmlContent(buffer.data(), buffer.size());
-
-        // 在HTML内容中插入userId
-        size_t headEnd = htmlContent.find("</head>");
-        if (headEnd != std::string::npos)
-        {
-            std::string script = "<script>const userId = '" + std::to_string(userId) + "';</script>";
-            htmlContent.insert(headEnd, script);
-        }
-
-        // server_->packageResp(req.getVersion(), HttpResponse::k200Ok, "OK"
-        //             , false, "text/html", htmlContent.size(), htmlContent, resp);
+        // 页面已预编译为模板，响应体由缓存的页面片段和注入的脚本组成
         resp->setStatusLine(req.getVersion(), http::HttpResponse::k200Ok, "OK");
         resp->setCloseConnection(false);
         resp->setContentType("text/html");
-        resp->setContentLength(htmlContent.size());
-        resp->setBody(htmlContent);
+        server_->renderUserPage(server_->menuPage_, userId, resp);
     }
     catch (const std::exception &e)
     {
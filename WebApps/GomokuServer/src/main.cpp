@@ -33,5 +33,7 @@ int main(int argc, char* argv[])
   muduo::Logger::setLogLevel(muduo::Logger::WARN);
   GomokuServer server(port, serverName);
   server.setThreadNum(4);
+  // AI落子、AI聊天等耗时处理在工作线程中执行
+  server.setWorkerThreadNum(4);
   server.start();
 }